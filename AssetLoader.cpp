@@ -0,0 +1,194 @@
+#include "AssetLoader.h"
+#include "FileUtils.h"
+#include "GLState.h"
+#include "TextureCompression.h"
+#include <stb/stb_image.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+TextureUploadStats textureStats = { 0, 0, 0, 0 };
+
+} // namespace
+
+bool IsDerivedFileCurrent(const std::string& derivedPath, const std::string& sourcePath) {
+    int64_t derivedModified, sourceModified;
+    if (!GetFileModifiedTime(derivedPath, derivedModified)) {
+        return false;
+    }
+    return !GetFileModifiedTime(sourcePath, sourceModified) || derivedModified >= sourceModified;
+}
+
+bool LoadImageData(const std::string& path, bool flipVertically, ImageData& image, int desiredChannels) {
+    // A compressed copy already holds the mip chain, so nothing is decoded or generated. One older than
+    // the image is stale; the image is decoded until it is compressed again.
+    if (desiredChannels == 0 && IsTextureCompressionEnabled()) {
+        std::string compressedPath = CompressedTexturePath(path);
+        if (IsDerivedFileCurrent(compressedPath, path)) {
+            if (LoadCompressedTexture(compressedPath, flipVertically, image)) {
+                return true;
+            }
+        }
+        else if (FileExists(compressedPath)) {
+            std::cout << "Ignoring " << compressedPath << ": older than " << path << std::endl;
+        }
+    }
+
+    // The flip flag is per thread so workers decoding different assets do not race on it
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+
+    int width, height, channels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, desiredChannels);
+    if (!data) {
+        std::cerr << "ERROR::ASSET_LOADER::FAILED_TO_LOAD_IMAGE: " << path << std::endl;
+        image = ImageData();
+        return false;
+    }
+
+    image = ImageData();
+    image.width = width;
+    image.height = height;
+    image.channels = desiredChannels != 0 ? desiredChannels : channels;
+    image.pixels.assign(data, data + static_cast<size_t>(width) * height * image.channels);
+    stbi_image_free(data);
+    return true;
+}
+
+GLuint CreateTexture2D(const ImageData& image, GLint wrapS, GLint wrapT) {
+    if (!image.IsValid()) {
+        return 0;
+    }
+
+    GLenum format = GL_RGB;
+    if (image.channels == 1)
+        format = GL_RED;
+    else if (image.channels == 4)
+        format = GL_RGBA;
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    BindTexture(0, GL_TEXTURE_2D, texture);
+
+    if (image.compressedFormat != 0) {
+        int width = image.width, height = image.height;
+        size_t offset = 0;
+        for (size_t level = 0; level < image.levelSizes.size(); ++level) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), image.compressedFormat, width, height, 0,
+                static_cast<GLsizei>(image.levelSizes[level]), image.pixels.data() + offset);
+            offset += image.levelSizes[level];
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levelSizes.size()) - 1);
+        ++textureStats.compressed;
+        textureStats.compressedBytes += image.pixels.size();
+    }
+    else {
+        // Rows of 1 and 3 channel images are not 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        // The mip chain adds a third to the top level
+        ++textureStats.uncompressed;
+        textureStats.uncompressedBytes += image.pixels.size() * 4 / 3;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return texture;
+}
+
+const TextureUploadStats& GetTextureUploadStats() {
+    return textureStats;
+}
+
+StartupTimeline::StartupTimeline() : origin(Clock::now()) {
+    threads.push_back(std::this_thread::get_id());
+}
+
+StartupTimeline::Scope::Scope(StartupTimeline& timeline, const std::string& name)
+    : timeline(timeline), name(name), start(Clock::now()) {
+}
+
+StartupTimeline::Scope::~Scope() {
+    timeline.Record(name, start, Clock::now());
+}
+
+void StartupTimeline::Record(const std::string& name, Clock::time_point start, Clock::time_point end) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::thread::id id = std::this_thread::get_id();
+    auto found = std::find(threads.begin(), threads.end(), id);
+    int thread = static_cast<int>(found - threads.begin());
+    if (found == threads.end()) {
+        threads.push_back(id);
+    }
+
+    Stage stage;
+    stage.name = name;
+    stage.startMs = std::chrono::duration<double, std::milli>(start - origin).count();
+    stage.endMs = std::chrono::duration<double, std::milli>(end - origin).count();
+    stage.thread = thread;
+    stages.push_back(stage);
+}
+
+// Length of the part of a stage during which at least one other stage was also running
+double StartupTimeline::overlapMs(size_t stageIndex) const {
+    const Stage& stage = stages[stageIndex];
+    std::vector<std::pair<double, double>> others;
+    for (size_t i = 0; i < stages.size(); ++i) {
+        double start = std::max(stages[i].startMs, stage.startMs);
+        double end = std::min(stages[i].endMs, stage.endMs);
+        if (i != stageIndex && end > start) {
+            others.push_back(std::make_pair(start, end));
+        }
+    }
+    std::sort(others.begin(), others.end());
+
+    double overlap = 0.0;
+    double coveredUntil = stage.startMs;
+    for (const auto& interval : others) {
+        double start = std::max(interval.first, coveredUntil);
+        if (interval.second > start) {
+            overlap += interval.second - start;
+            coveredUntil = interval.second;
+        }
+    }
+    return overlap;
+}
+
+void StartupTimeline::Print(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<size_t> order(stages.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return stages[a].startMs < stages[b].startMs; });
+
+    char line[160];
+    out << "Startup timeline:" << std::endl;
+    std::snprintf(line, sizeof(line), "  %-24s %-9s %9s %12s %14s", "stage", "thread", "start ms", "duration ms", "overlapped ms");
+    out << line << std::endl;
+
+    double stageTotalMs = 0.0;
+    double endMs = 0.0;
+    for (size_t index : order) {
+        const Stage& stage = stages[index];
+        std::string thread = stage.thread == 0 ? "main" : "worker " + std::to_string(stage.thread);
+        std::snprintf(line, sizeof(line), "  %-24s %-9s %9.1f %12.1f %14.1f", stage.name.c_str(), thread.c_str(),
+            stage.startMs, stage.endMs - stage.startMs, overlapMs(index));
+        out << line << std::endl;
+        stageTotalMs += stage.endMs - stage.startMs;
+        endMs = std::max(endMs, stage.endMs);
+    }
+
+    std::snprintf(line, sizeof(line), "  Ready after %.1f ms; stages took %.1f ms in total", endMs, stageTotalMs);
+    out << line << std::endl;
+}
@@ -0,0 +1,91 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+
+// Decoded 8-bit image, ready to be handed to the GL thread
+struct ImageData {
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    // Set for block-compressed images: pixels holds every mip level, largest first, levelSizes bytes each
+    GLenum compressedFormat = 0;
+    std::vector<size_t> levelSizes;
+
+    bool IsValid() const { return !pixels.empty(); }
+};
+
+// Decodes an image with stb_image; safe to call from any thread. desiredChannels 0 keeps the file's channels
+// and loads the block-compressed copy from --compress-texture instead when there is one, it is not older than
+// the image and the driver supports it.
+bool LoadImageData(const std::string& path, bool flipVertically, ImageData& image, int desiredChannels = 0);
+
+// True when the file generated from sourcePath exists and was modified no earlier than sourcePath, or
+// sourcePath is gone. Derived files compare modification times, like the track cache does.
+bool IsDerivedFileCurrent(const std::string& derivedPath, const std::string& sourcePath);
+
+// Uploads an image as a mipmapped 2D texture; requires the GL context. Compressed images bring their own
+// mip levels, others have them generated. Returns 0 for an empty image.
+GLuint CreateTexture2D(const ImageData& image, GLint wrapS, GLint wrapT);
+
+// Textures created by CreateTexture2D and the memory their mip chains take
+struct TextureUploadStats {
+    int compressed;
+    int uncompressed;
+    size_t compressedBytes;
+    size_t uncompressedBytes;
+};
+
+const TextureUploadStats& GetTextureUploadStats();
+
+// Wall-clock record of the loading stages, possibly running on several threads at once
+class StartupTimeline {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Times everything relative to construction; the constructing thread is reported as "main"
+    StartupTimeline();
+
+    // Records a stage on the calling thread for the lifetime of the scope
+    class Scope {
+    public:
+        Scope(StartupTimeline& timeline, const std::string& name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        StartupTimeline& timeline;
+        std::string name;
+        Clock::time_point start;
+    };
+
+    void Record(const std::string& name, Clock::time_point start, Clock::time_point end);
+
+    // Per-stage start, duration and time overlapped with any other stage, plus the total wall time
+    void Print(std::ostream& out) const;
+
+private:
+    struct Stage {
+        std::string name;
+        double startMs;
+        double endMs;
+        int thread;
+    };
+
+    Clock::time_point origin;
+    std::vector<std::thread::id> threads;  // Index 0 is the main thread
+    std::vector<Stage> stages;
+    mutable std::mutex mutex;
+
+    double overlapMs(size_t stageIndex) const;
+};
+
+#endif
@@ -0,0 +1,1383 @@
+#include "Benchmarks.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Terrain.h"
+#include "TerrainQuadtree.h"
+#include "TerrainLOD.h"
+#include "TerrainCompact.h"
+#include "TerrainTopology.h"
+#include "TerrainNormals.h"
+#include "TerrainSampling.h"
+#include "TiledHeightmap.h"
+#include "Path.h"
+#include "PathLOD.h"
+#include "PathTrail.h"
+#include "Simulation.h"
+#include "SkyDome.h"
+#include "AssetLoader.h"
+#include "TextureCompression.h"
+#include "ThreadPool.h"
+#include "GpxReader.h"
+#include "TrackCache.h"
+#include <pugixml/src/pugixml.hpp>
+
+namespace {
+
+const char* HEIGHTMAP_PATH = "assets/heightmaps/terrain_heightmap.png";
+const char* GPX_PATH = "assets/gpx/hiking_path.gpx";
+const float BENCH_VIEWPORT_WIDTH = 1280.0f;
+const float BENCH_VIEWPORT_HEIGHT = 720.0f;
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Triangle counts for full resolution vs geomipmapped terrain over a set of camera poses
+bool benchTerrainLOD() {
+    std::vector<float> heightData;
+    int width, height;
+    if (!Terrain::LoadHeightmapData(HEIGHTMAP_PATH, heightData, width, height)) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TerrainQuadtree quadtree;
+    quadtree.Build(heightData, width, height);
+    double quadtreeMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    TerrainLOD lod;
+    lod.Build(quadtree, heightData, width, width);
+    double lodMs = elapsedMs(start);
+
+    unsigned long long fullTriangles = static_cast<unsigned long long>(width - 1) * (height - 1) * 2;
+    std::printf("terrain-lod: %dx%d samples, %d chunks, %d levels\n", width, height, quadtree.GetChunkCount(), lod.GetLevelCount());
+    std::printf("  build: quadtree %.2f ms, lod errors + patterns %.2f ms (%zu pattern indices)\n",
+        quadtreeMs, lodMs, lod.GetIndices().size());
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), BENCH_VIEWPORT_WIDTH / BENCH_VIEWPORT_HEIGHT, 0.1f, 1000.0f);
+    unsigned long long totalCulled = 0, totalLOD = 0;
+    double selectMs = 0.0;
+    int poses = 0;
+
+    std::printf("  %-28s %12s %12s %12s\n", "camera", "full", "culled", "culled+lod");
+    for (int step = 1; step <= 4; ++step) {
+        for (int direction = 0; direction < 4; ++direction) {
+            glm::vec3 position(width * step / 5.0f, 0.0f, height * step / 5.0f);
+            position.y = heightData[static_cast<int>(position.z) * width + static_cast<int>(position.x)] + 2.0f;
+            float yaw = glm::radians(45.0f + 90.0f * direction);
+            glm::vec3 front(std::cos(yaw), -0.1f, std::sin(yaw));
+            glm::mat4 view = glm::lookAt(position, position + front, glm::vec3(0.0f, 1.0f, 0.0f));
+
+            std::vector<int> visibleChunks;
+            quadtree.Cull(Frustum(projection * view), visibleChunks);
+            unsigned long long culledTriangles = 0;
+            for (int chunkIndex : visibleChunks) {
+                const TerrainChunk& chunk = quadtree.GetChunks()[chunkIndex];
+                culledTriangles += static_cast<unsigned long long>(chunk.quadsX) * chunk.quadsZ * 2;
+            }
+
+            start = std::chrono::steady_clock::now();
+            std::vector<int> levels;
+            lod.SelectLevels(quadtree, MakeTerrainLODView(position, glm::radians(45.0f), BENCH_VIEWPORT_HEIGHT), levels);
+            unsigned long long lodTriangles = 0;
+            for (int chunkIndex : visibleChunks) {
+                int edgeMask = lod.GetEdgeMask(quadtree, levels, chunkIndex);
+                lodTriangles += lod.GetPattern(chunkIndex, levels[chunkIndex], edgeMask).indexCount / 3;
+            }
+            selectMs += elapsedMs(start);
+
+            char label[64];
+            std::snprintf(label, sizeof(label), "(%.0f, %.0f) yaw %d", position.x, position.z, 45 + 90 * direction);
+            std::printf("  %-28s %12llu %12llu %12llu\n", label, fullTriangles, culledTriangles, lodTriangles);
+            totalCulled += culledTriangles;
+            totalLOD += lodTriangles;
+            ++poses;
+        }
+    }
+
+    std::printf("  average triangles: full %llu, culled %llu (%.1f%%), culled+lod %llu (%.1f%%)\n",
+        fullTriangles, totalCulled / poses, 100.0 * totalCulled / (static_cast<double>(fullTriangles) * poses),
+        totalLOD / poses, 100.0 * totalLOD / (static_cast<double>(fullTriangles) * poses));
+    std::printf("  level selection + edge masks: %.3f ms per frame\n", selectMs / poses);
+
+    // Every pair of neighbouring chunks, the second east or south of the first
+    const std::vector<TerrainChunk>& chunks = quadtree.GetChunks();
+    struct Neighbours {
+        int first, second;
+        bool east;
+    };
+    std::vector<Neighbours> neighbours;
+    for (int chunkZ = 0; chunkZ < quadtree.GetChunksZ(); ++chunkZ) {
+        for (int chunkX = 0; chunkX < quadtree.GetChunksX(); ++chunkX) {
+            int chunkIndex = quadtree.GetChunkIndexAt(chunkX, chunkZ);
+            int east = quadtree.GetChunkIndexAt(chunkX + 1, chunkZ);
+            int south = quadtree.GetChunkIndexAt(chunkX, chunkZ + 1);
+            if (chunkIndex >= 0 && east >= 0) {
+                neighbours.push_back({ chunkIndex, east, true });
+            }
+            if (chunkIndex >= 0 && south >= 0) {
+                neighbours.push_back({ chunkIndex, south, false });
+            }
+        }
+    }
+
+    // Triangle edges of a chunk's pattern that lie on the grid line x == line (or z == line), as
+    // sorted pairs of terrain vertex indices. Neighbours stitch without cracks when theirs are equal.
+    typedef std::pair<unsigned int, unsigned int> Segment;
+    auto edgeSegments = [&](int chunkIndex, const std::vector<int>& levels, bool alongZ, int line, std::vector<Segment>& segments) {
+        const TerrainChunk& chunk = chunks[chunkIndex];
+        const TerrainLOD::Pattern& pattern = lod.GetPattern(chunkIndex, levels[chunkIndex], lod.GetEdgeMask(quadtree, levels, chunkIndex));
+        const unsigned int* triangles = lod.GetIndices().data() + pattern.firstIndex;
+        auto onLine = [&](unsigned int local) {
+            int x = chunk.originX + static_cast<int>(local % width);
+            int z = chunk.originZ + static_cast<int>(local / width);
+            return (alongZ ? x : z) == line;
+        };
+        auto global = [&](unsigned int local) {
+            return static_cast<unsigned int>(chunk.originZ * width + chunk.originX) + local;
+        };
+        segments.clear();
+        for (unsigned int t = 0; t < pattern.indexCount; t += 3) {
+            for (int corner = 0; corner < 3; ++corner) {
+                unsigned int a = triangles[t + corner], b = triangles[t + (corner + 1) % 3];
+                if (onLine(a) && onLine(b)) {
+                    segments.push_back(Segment(std::min(global(a), global(b)), std::max(global(a), global(b))));
+                }
+            }
+        }
+        std::sort(segments.begin(), segments.end());
+        segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+    };
+
+    // Random views over the whole map, every chunk checked whether visible or not
+    unsigned int seed = 12345u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+    const int views = 200;
+    size_t pairsChecked = 0, cracks = 0, levelJumps = 0;
+    std::vector<int> levels;
+    std::vector<Segment> firstSegments, secondSegments;
+    for (int view = 0; view < views; ++view) {
+        glm::vec3 position(random() * (width - 1), 0.0f, random() * (height - 1));
+        position.y = heightData[static_cast<int>(position.z) * width + static_cast<int>(position.x)] + 2.0f + random() * 200.0f;
+        lod.SelectLevels(quadtree, MakeTerrainLODView(position, glm::radians(45.0f), BENCH_VIEWPORT_HEIGHT), levels);
+        for (const Neighbours& pair : neighbours) {
+            levelJumps += std::abs(levels[pair.first] - levels[pair.second]) > 1;
+            const TerrainChunk& first = chunks[pair.first];
+            int line = pair.east ? first.originX + first.quadsX : first.originZ + first.quadsZ;
+            edgeSegments(pair.first, levels, pair.east, line, firstSegments);
+            edgeSegments(pair.second, levels, pair.east, line, secondSegments);
+            cracks += firstSegments.empty() || firstSegments != secondSegments;
+            ++pairsChecked;
+        }
+    }
+
+    // Moving towards a chunk never selects a coarser level
+    TerrainLODView lodView = MakeTerrainLODView(glm::vec3(0.0f), glm::radians(45.0f), BENCH_VIEWPORT_HEIGHT);
+    size_t coarserWhenCloser = 0;
+    for (int chunkIndex = 0; chunkIndex < quadtree.GetChunkCount(); ++chunkIndex) {
+        int previous = lod.GetLevelCount();
+        for (float distance = 4000.0f; distance > 1e-4f; distance *= 0.9f) {
+            int level = SelectTerrainLOD(lod.GetLevelErrors(chunkIndex), lod.GetLevelCount(), distance,
+                lodView.projectionScale, lod.PixelTolerance);
+            coarserWhenCloser += level > previous;
+            previous = level;
+        }
+    }
+
+    std::printf("  stitching: %zu chunk-edge pairs over %d views, %zu with mismatched edges, %zu more than one level apart\n",
+        pairsChecked, views, cracks, levelJumps);
+    std::printf("  selection: %zu coarser levels picked closer to a chunk\n", coarserWhenCloser);
+    return cracks == 0 && levelJumps == 0 && coarserWhenCloser == 0;
+}
+
+// Memory of the compact vertex format and its decode error against the full Terrain::BuildMesh vertices
+bool benchTerrainCompact() {
+    std::vector<float> heightData;
+    int width, height;
+    if (!Terrain::LoadHeightmapData(HEIGHTMAP_PATH, heightData, width, height)) {
+        return false;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    TerrainQuadtree quadtree;
+    Terrain::BuildVertices(heightData, width, height, vertices);
+    quadtree.Build(heightData, width, height);
+    Terrain::BuildIndices(quadtree, width, indices);
+    Terrain::ComputeFaceNormals(vertices, indices);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<CompactTerrainVertex> compactVertices;
+    CompactTerrainLayout layout;
+    EncodeCompactTerrain(vertices, width, height, TERRAIN_UV_SCALE, compactVertices, layout);
+    double encodeMs = elapsedMs(start);
+
+    float maxPositionError = 0.0f, maxUVError = 0.0f, maxNormalDegrees = 0.0f;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        Vertex decoded = DecodeCompactTerrainVertex(compactVertices[i], static_cast<unsigned int>(i), layout);
+        maxPositionError = std::max(maxPositionError, glm::length(decoded.Position - vertices[i].Position));
+        maxUVError = std::max(maxUVError, glm::length(decoded.TexCoords - vertices[i].TexCoords));
+        float cosine = glm::clamp(glm::dot(decoded.Normal, vertices[i].Normal), -1.0f, 1.0f);
+        maxNormalDegrees = std::max(maxNormalDegrees, glm::degrees(std::acos(cosine)));
+    }
+
+    double fullMB = vertices.size() * sizeof(Vertex) / (1024.0 * 1024.0);
+    double compactMB = compactVertices.size() * sizeof(CompactTerrainVertex) / (1024.0 * 1024.0);
+    std::printf("terrain-compact: %zu vertices, full %.1f MB, compact %.1f MB (%.1fx smaller), encode %.2f ms\n",
+        vertices.size(), fullMB, compactMB, fullMB / compactMB, encodeMs);
+    // Half a 16-bit height step plus float rounding of the decode, float UV rounding and 8-bit
+    // octahedral quantization
+    float positionTolerance = 0.5f * layout.heightRange / 65535.0f + 1e-4f;
+    std::printf("  max error: position %.5f of %.5f, uv %.6f, normal %.3f degrees\n", maxPositionError, positionTolerance,
+        maxUVError, maxNormalDegrees);
+
+    bool withinTolerance = maxPositionError <= positionTolerance
+        && maxUVError <= 1e-4f
+        && maxNormalDegrees <= 2.0f;
+    if (!withinTolerance) {
+        std::printf("  decoded vertices exceed tolerance\n");
+    }
+    return withinTolerance;
+}
+
+// Index memory and build time of the global triangle list vs shared 16-bit chunk strips
+bool benchTerrainTopology() {
+    std::vector<float> heightData;
+    int width, height;
+    if (!Terrain::LoadHeightmapData(HEIGHTMAP_PATH, heightData, width, height)) {
+        return false;
+    }
+
+    TerrainQuadtree quadtree;
+    quadtree.Build(heightData, width, height);
+
+    const int iterations = 5;
+    double trianglesMs = 0.0, stripsMs = 0.0, remapMs = 0.0;
+    size_t triangleBytes = 0, stripBytes = 0, remapVertices = 0;
+    std::vector<unsigned int> indices, remap;
+    TerrainStripTopology topology;
+    for (int i = 0; i < iterations; ++i) {
+        // Fresh containers each time, so every build allocates as it would on first load
+        std::vector<unsigned int>().swap(indices);
+        std::vector<unsigned int>().swap(remap);
+        topology = TerrainStripTopology();
+
+        auto start = std::chrono::steady_clock::now();
+        Terrain::BuildIndices(quadtree, width, indices);
+        trianglesMs += elapsedMs(start);
+        triangleBytes = indices.size() * sizeof(unsigned int);
+
+        start = std::chrono::steady_clock::now();
+        topology.Build(quadtree);
+        stripsMs += elapsedMs(start);
+        stripBytes = topology.GetIndices().size() * sizeof(uint16_t);
+
+        start = std::chrono::steady_clock::now();
+        topology.BuildVertexRemap(quadtree, width, remap);
+        remapMs += elapsedMs(start);
+        remapVertices = remap.size();
+    }
+
+    // Triangles as row-major vertex triples, rotated so the smallest index comes first; the winding is kept
+    typedef std::array<unsigned int, 3> Triangle;
+    auto addTriangle = [](std::vector<Triangle>& triangles, unsigned int a, unsigned int b, unsigned int c) {
+        if (a == b || b == c || a == c) {
+            return;
+        }
+        if (b < a && b < c) {
+            triangles.push_back({ { b, c, a } });
+        }
+        else if (c < a && c < b) {
+            triangles.push_back({ { c, a, b } });
+        }
+        else {
+            triangles.push_back({ { a, b, c } });
+        }
+    };
+    std::vector<Triangle> listTriangles, stripTriangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        addTriangle(listTriangles, indices[i], indices[i + 1], indices[i + 2]);
+    }
+
+    // Expands every chunk's strips as GL does with primitive restart: every other triangle of a strip
+    // swaps its first two vertices. Chunk-major slots map back to row-major vertices through the remap.
+    const std::vector<uint16_t>& stripIndices = topology.GetIndices();
+    for (const TerrainChunk& chunk : quadtree.GetChunks()) {
+        int chunkIndex = static_cast<int>(&chunk - quadtree.GetChunks().data());
+        const TerrainStripTopology::Pattern& pattern = topology.GetPattern(chunkIndex);
+        unsigned int baseVertex = static_cast<unsigned int>(topology.GetBaseVertex(chunk));
+        size_t stripStart = pattern.firstIndex;
+        size_t end = pattern.firstIndex + pattern.indexCount;
+        for (size_t i = pattern.firstIndex; i <= end; ++i) {
+            if (i < end && stripIndices[i] != TERRAIN_RESTART_INDEX) {
+                continue;
+            }
+            for (size_t k = stripStart; k + 2 < i; ++k) {
+                unsigned int a = remap[baseVertex + stripIndices[k]];
+                unsigned int b = remap[baseVertex + stripIndices[k + 1]];
+                unsigned int c = remap[baseVertex + stripIndices[k + 2]];
+                if ((k - stripStart) % 2 == 0) {
+                    addTriangle(stripTriangles, a, b, c);
+                }
+                else {
+                    addTriangle(stripTriangles, b, a, c);
+                }
+            }
+            stripStart = i + 1;
+        }
+    }
+    std::sort(listTriangles.begin(), listTriangles.end());
+    std::sort(stripTriangles.begin(), stripTriangles.end());
+    bool sameTriangles = !listTriangles.empty() && listTriangles == stripTriangles;
+
+    std::printf("terrain-topology: %dx%d samples, %d chunks\n", width, height, quadtree.GetChunkCount());
+    std::printf("  triangle list (u32): %8.2f MB, build %8.3f ms\n", triangleBytes / (1024.0 * 1024.0), trianglesMs / iterations);
+    std::printf("  shared strips (u16): %8.3f MB, build %8.3f ms\n", stripBytes / (1024.0 * 1024.0), stripsMs / iterations);
+    std::printf("  chunk-major vertex remap: %.3f ms, %zu vertices (%.1f%% over %d samples)\n", remapMs / iterations,
+        remapVertices, 100.0 * (static_cast<double>(remapVertices) / (static_cast<double>(width) * height) - 1.0), width * height);
+    std::printf("  triangles: %zu in the list, %zu from the strips, %s\n", listTriangles.size(), stripTriangles.size(),
+        sameTriangles ? "identical" : "DIFFER");
+    return sameTriangles;
+}
+
+// Milliseconds per megasample for each normal generator, and their deviation from the face-averaged reference
+bool benchTerrainNormals() {
+    std::vector<float> heightData;
+    int width, height;
+    if (!Terrain::LoadHeightmapData(HEIGHTMAP_PATH, heightData, width, height)) {
+        return false;
+    }
+
+    std::vector<Vertex> reference;
+    std::vector<unsigned int> indices;
+    TerrainQuadtree quadtree;
+    Terrain::BuildVertices(heightData, width, height, reference);
+    quadtree.Build(heightData, width, height);
+    Terrain::BuildIndices(quadtree, width, indices);
+
+    const int iterations = 5;
+    double megasamples = static_cast<double>(width) * height / 1e6;
+    std::printf("terrain-normals: %dx%d samples (%.2f MS), %u hardware threads\n", width, height, megasamples,
+        std::thread::hardware_concurrency());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        Terrain::ComputeFaceNormals(reference, indices);
+    }
+    std::printf("  %-34s %8.2f ms/MS\n", "face average (reference)", elapsedMs(start) / iterations / megasamples);
+
+    struct Variant {
+        const char* name;
+        Terrain_NormalMode mode;
+        int threads;
+    };
+    const Variant variants[] = {
+        { "central difference, 1 thread", NORMALS_CENTRAL_DIFFERENCE, 1 },
+        { "central difference, all threads", NORMALS_CENTRAL_DIFFERENCE, 0 },
+        { "sobel, 1 thread", NORMALS_SOBEL, 1 },
+        { "sobel, all threads", NORMALS_SOBEL, 0 },
+    };
+
+    // Gradient normals differ from face averages mostly on steep cliffs; the means are about 0.9 and 0.8 degrees
+    const double maxMeanDegrees = 1.5;
+    // Bands of rows per thread must not change the result, so a fixed odd split is compared too when
+    // the machine has few cores
+    const int splitThreads = 7;
+
+    bool meansWithinBound = true, threadsIdentical = true;
+    std::vector<glm::vec3> normals(reference.size()), singleThread(reference.size()), split(reference.size());
+    for (const Variant& variant : variants) {
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            ComputeHeightFieldNormals(heightData.data(), width, height, variant.mode, normals.data(), sizeof(glm::vec3), variant.threads);
+        }
+        double msPerMegasample = elapsedMs(start) / iterations / megasamples;
+
+        double sumDegrees = 0.0;
+        float maxDegrees = 0.0f;
+        for (size_t i = 0; i < normals.size(); ++i) {
+            float degrees = glm::degrees(std::acos(glm::clamp(glm::dot(normals[i], reference[i].Normal), -1.0f, 1.0f)));
+            sumDegrees += degrees;
+            maxDegrees = std::max(maxDegrees, degrees);
+        }
+        double meanDegrees = sumDegrees / normals.size();
+        std::printf("  %-34s %8.2f ms/MS  (vs reference: mean %.2f, max %.2f degrees)\n", variant.name, msPerMegasample,
+            meanDegrees, maxDegrees);
+        meansWithinBound = meansWithinBound && meanDegrees <= maxMeanDegrees;
+
+        // Threaded runs must match the single-threaded one exactly
+        if (variant.threads == 1) {
+            singleThread = normals;
+            continue;
+        }
+        ComputeHeightFieldNormals(heightData.data(), width, height, variant.mode, split.data(), sizeof(glm::vec3), splitThreads);
+        bool identical = std::memcmp(normals.data(), singleThread.data(), normals.size() * sizeof(glm::vec3)) == 0
+            && std::memcmp(split.data(), singleThread.data(), split.size() * sizeof(glm::vec3)) == 0;
+        std::printf("  %-34s all threads and %d threads %s to 1 thread\n", "", splitThreads, identical ? "identical" : "NOT identical");
+        threadsIdentical = threadsIdentical && identical;
+    }
+    std::printf("  mean deviations %s %.1f degrees\n", meansWithinBound ? "within" : "NOT within", maxMeanDegrees);
+    return meansWithinBound && threadsIdentical;
+}
+
+// One million random bilinear height queries: per-point calls vs the batched SIMD path
+bool benchTerrainSampling() {
+    std::vector<float> heightData;
+    int width, height;
+    if (!Terrain::LoadHeightmapData(HEIGHTMAP_PATH, heightData, width, height)) {
+        return false;
+    }
+
+    const size_t pointCount = 1000000;
+    std::vector<glm::vec2> points(pointCount);
+    unsigned int seed = 12345u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+    for (glm::vec2& point : points) {
+        point = glm::vec2(random() * (width - 1), random() * (height - 1));
+    }
+    // A few NaN and infinite coordinates, which both paths must sample as 0
+    const float nonFinite[] = { NAN, INFINITY, -INFINITY };
+    size_t nonFiniteCount = 0;
+    for (size_t i = 7; i < pointCount; i += 997) {
+        points[i][(i / 997) % 2] = nonFinite[(i / 997) % 3];
+        ++nonFiniteCount;
+    }
+
+    std::vector<float> single(pointCount), batched(pointCount);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pointCount; ++i) {
+        single[i] = SampleHeightBilinear(heightData.data(), width, height, points[i].x, points[i].y);
+    }
+    double singleMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    SampleHeightsBilinear(heightData.data(), width, height, points.data(), batched.data(), pointCount);
+    double batchedMs = elapsedMs(start);
+
+    float maxDifference = 0.0f;
+    bool nonFiniteZero = true;
+    for (size_t i = 0; i < pointCount; ++i) {
+        maxDifference = std::max(maxDifference, std::abs(single[i] - batched[i]));
+        if (!std::isfinite(points[i].x) || !std::isfinite(points[i].y)) {
+            nonFiniteZero = nonFiniteZero && single[i] == 0.0f && batched[i] == 0.0f;
+        }
+    }
+    std::printf("terrain-sampling: %zu random points on %dx%d, %zu of them NaN or infinite\n", pointCount, width, height,
+        nonFiniteCount);
+    std::printf("  per-point: %8.2f ms (%.1f ns/point)\n", singleMs, singleMs * 1e6 / pointCount);
+    std::printf("  batched:   %8.2f ms (%.1f ns/point), max difference %g\n", batchedMs, batchedMs * 1e6 / pointCount, maxDifference);
+    std::printf("  non-finite points: %s\n", nonFiniteZero ? "sampled as 0" : "WRONG");
+    return maxDifference <= 1e-4f && nonFiniteZero;
+}
+
+// Streaming a tiled copy of the heightmap through a 16-tile cache along a walk across the map,
+// checked sample for sample against the PNG heights
+bool benchTerrainTiles() {
+    std::vector<float> heightData;
+    int width, height;
+    if (!Terrain::LoadHeightmapData(HEIGHTMAP_PATH, heightData, width, height)) {
+        return false;
+    }
+
+    const char* tiledPath = "terrain_tiles_bench.hmt";
+    const int tileSize = 64;
+    const size_t budgetTiles = 16;
+    const float radius = 96.0f;
+    auto start = std::chrono::steady_clock::now();
+    if (!ConvertHeightmapToTiles(HEIGHTMAP_PATH, tiledPath, tileSize)) {
+        return false;
+    }
+    double convertMs = elapsedMs(start);
+
+    TiledHeightmap tiled;
+    if (!tiled.Open(tiledPath, budgetTiles * tileSize * tileSize * sizeof(float))) {
+        std::remove(tiledPath);
+        return false;
+    }
+
+    // Walk the diagonal; the resident set has to stay within the budget the whole way
+    const int steps = 200;
+    bool withinBudget = true;
+    glm::vec3 position(0.0f);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i <= steps; ++i) {
+        float t = static_cast<float>(i) / steps;
+        position = glm::vec3(t * (width - 1), 0.0f, t * (height - 1));
+        tiled.Update(position, radius);
+        withinBudget = withinBudget && tiled.GetResidentTileCount() <= budgetTiles;
+    }
+    double walkMs = elapsedMs(start);
+
+    // The tile under the walker is still resident, so acquiring it loads nothing
+    size_t loadsBefore = tiled.GetTileLoads();
+    tiled.AcquireTile(static_cast<int>(position.x) / tileSize, static_cast<int>(position.z) / tileSize);
+    bool nearestResident = tiled.GetTileLoads() == loadsBefore;
+
+    // Every sample, whether it comes from a resident tile or straight from the mapping
+    size_t sampleMismatches = 0;
+    for (int z = 0; z < height; ++z) {
+        for (int x = 0; x < width; ++x) {
+            if (tiled.GetSample(x, z) != heightData[static_cast<size_t>(z) * width + x]) {
+                ++sampleMismatches;
+            }
+        }
+    }
+    size_t tileLoads = tiled.GetTileLoads();
+    size_t tileEvictions = tiled.GetTileEvictions();
+    tiled.Close();
+
+    // The terrain serves heights and builds its mesh from the tiles without keeping the whole map
+    Terrain imageTerrain{ TerrainOptions() };
+    Terrain tiledTerrain{ TerrainOptions() };
+    if (!imageTerrain.LoadHeightmap(HEIGHTMAP_PATH) || !tiledTerrain.LoadHeightmap(tiledPath)) {
+        std::remove(tiledPath);
+        return false;
+    }
+    unsigned int seed = 12345u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+    size_t heightMismatches = 0;
+    for (int i = 0; i < 100000; ++i) {
+        float x = random() * (width - 1);
+        float z = random() * (height - 1);
+        if (tiledTerrain.GetHeightAt(x, z) != imageTerrain.GetHeightAt(x, z)) {
+            ++heightMismatches;
+        }
+    }
+
+    imageTerrain.BuildMesh();
+    start = std::chrono::steady_clock::now();
+    tiledTerrain.BuildMesh();
+    double buildMs = elapsedMs(start);
+    const std::vector<TerrainChunk>& imageChunks = imageTerrain.GetQuadtree().GetChunks();
+    const std::vector<TerrainChunk>& tiledChunks = tiledTerrain.GetQuadtree().GetChunks();
+    bool sameChunks = imageChunks.size() == tiledChunks.size();
+    for (size_t i = 0; sameChunks && i < imageChunks.size(); ++i) {
+        sameChunks = imageChunks[i].bounds.min == tiledChunks[i].bounds.min && imageChunks[i].bounds.max == tiledChunks[i].bounds.max;
+    }
+    tiledTerrain.UpdateStreaming(glm::vec3(width * 0.5f, 0.0f, height * 0.5f));
+    bool streamed = tiledTerrain.GetTiledHeightmap().GetResidentTileCount() > 0;
+    std::remove(tiledPath);
+
+    std::printf("terrain-tiles: %dx%d in tiles of %d, budget %zu tiles, radius %.0f\n", width, height, tileSize, budgetTiles, radius);
+    std::printf("  convert:    %8.2f ms\n", convertMs);
+    std::printf("  walk:       %8.2f ms over %d updates, %zu loads, %zu evictions, %s budget\n", walkMs, steps + 1,
+        tileLoads, tileEvictions, withinBudget ? "within" : "OVER");
+    std::printf("  samples:    %zu of %d differ from the PNG, %zu of 100000 bilinear heights differ\n",
+        sampleMismatches, width * height, heightMismatches);
+    std::printf("  mesh build: %8.2f ms from tiles, chunk bounds %s\n", buildMs, sameChunks ? "identical" : "DIFFER");
+    return withinBudget && tileEvictions > 0 && nearestResident && sampleMismatches == 0 && heightMismatches == 0
+        && sameChunks && streamed;
+}
+
+// CPU side of the startup asset loading, run in sequence and then on the loader pool as main() does
+bool benchAssetLoading() {
+    bool success = true;
+    double wallMs[2];
+    for (int pooled = 0; pooled < 2; ++pooled) {
+        StartupTimeline timeline;
+        Terrain terrain{ TerrainOptions() };
+        Path path;
+        SkyDome skyDome;
+        auto start = std::chrono::steady_clock::now();
+        {
+            // A single worker runs the stages one after another in submission order
+            ThreadPool pool(pooled ? 0 : 1);
+            std::shared_future<bool> heightmapLoaded = pool.Submit([&]() {
+                StartupTimeline::Scope stage(timeline, "terrain heightmap");
+                return terrain.LoadHeightmap(HEIGHTMAP_PATH);
+            }).share();
+            std::shared_future<bool> gpxLoaded = pool.Submit([&]() {
+                StartupTimeline::Scope stage(timeline, "gpx parse");
+                return path.Load(GPX_PATH);
+            }).share();
+            std::future<void> terrainMeshBuilt = pool.Submit([&]() {
+                heightmapLoaded.wait();
+                StartupTimeline::Scope stage(timeline, "terrain mesh");
+                terrain.BuildMesh();
+            });
+            std::future<void> pathPlaced = pool.Submit([&]() {
+                heightmapLoaded.wait();
+                gpxLoaded.wait();
+                StartupTimeline::Scope stage(timeline, "path placement");
+                path.PlaceOnTerrain(terrain);
+            });
+            std::future<bool> terrainTextureLoaded = pool.Submit([&]() {
+                StartupTimeline::Scope stage(timeline, "terrain texture");
+                return terrain.LoadTextureData("assets/textures/terrain_texture.png");
+            });
+            std::future<bool> grassTextureLoaded = pool.Submit([&]() {
+                StartupTimeline::Scope stage(timeline, "grass texture");
+                return terrain.LoadGrassTextureData("assets/textures/grass_texture.png");
+            });
+            std::future<bool> skyDomeLoaded = pool.Submit([&]() {
+                StartupTimeline::Scope stage(timeline, "sky dome");
+                return skyDome.LoadData("assets/skydome/sky_dome_texture.png");
+            });
+
+            terrainMeshBuilt.wait();
+            pathPlaced.wait();
+            // The grass texture is optional and not shipped with every asset set
+            grassTextureLoaded.wait();
+            success = heightmapLoaded.get() && gpxLoaded.get() && terrainTextureLoaded.get()
+                && skyDomeLoaded.get() && success;
+            std::printf("asset-loading: %s (%d worker threads)\n", pooled ? "pooled" : "sequential", pool.GetThreadCount());
+        }
+        wallMs[pooled] = elapsedMs(start);
+        timeline.Print(std::cout);
+    }
+    std::printf("asset-loading: sequential %.1f ms, pooled %.1f ms (%.2fx)\n", wallMs[0], wallMs[1], wallMs[0] / wallMs[1]);
+    return success;
+}
+
+// Bytes currently and at most allocated by pugixml, to size the DOM
+size_t pugiAllocatedBytes = 0;
+size_t pugiPeakBytes = 0;
+
+void* countingAllocate(size_t size) {
+    // The size is kept in front of the block so deallocation can subtract it
+    size_t* block = static_cast<size_t*>(std::malloc(size + sizeof(max_align_t)));
+    if (!block) {
+        return nullptr;
+    }
+    *block = size;
+    pugiAllocatedBytes += size;
+    pugiPeakBytes = std::max(pugiPeakBytes, pugiAllocatedBytes);
+    return reinterpret_cast<char*>(block) + sizeof(max_align_t);
+}
+
+void countingDeallocate(void* pointer) {
+    if (pointer) {
+        size_t* block = reinterpret_cast<size_t*>(static_cast<char*>(pointer) - sizeof(max_align_t));
+        pugiAllocatedBytes -= *block;
+        std::free(block);
+    }
+}
+
+// Bitwise, so missing values (NaN) compare equal
+template <typename T>
+bool sameColumn(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+bool sameTracks(const Track& a, const Track& b) {
+    bool same = sameColumn(a.GetTimes(), b.GetTimes()) && sameColumn(a.GetLatitudes(), b.GetLatitudes())
+        && sameColumn(a.GetLongitudes(), b.GetLongitudes());
+    for (int channel = 0; channel < TRACK_CHANNEL_COUNT; ++channel) {
+        same = same && sameColumn(a.GetChannel(static_cast<Track_Channel>(channel)), b.GetChannel(static_cast<Track_Channel>(channel)));
+    }
+    return same;
+}
+
+// Writes the sample GPX with its track points repeated; returns the file size in MB, or 0 on failure
+double writeScaledGpx(const char* scaledPath, int repeats) {
+    std::ifstream source(GPX_PATH, std::ios::binary);
+    std::stringstream contents;
+    contents << source.rdbuf();
+    std::string gpx = contents.str();
+    size_t firstPoint = gpx.find("<trkpt");
+    size_t segmentEnd = gpx.rfind("</trkseg>");
+    if (firstPoint == std::string::npos || segmentEnd == std::string::npos) {
+        std::cerr << "ERROR::BENCHMARK::NO_TRACK_POINTS: " << GPX_PATH << '\n';
+        return 0.0;
+    }
+
+    std::ofstream scaled(scaledPath, std::ios::binary);
+    scaled << gpx.substr(0, firstPoint);
+    for (int i = 0; i < repeats; ++i) {
+        scaled.write(gpx.data() + firstPoint, segmentEnd - firstPoint);
+    }
+    scaled << gpx.substr(segmentEnd);
+    return (firstPoint + (segmentEnd - firstPoint) * repeats + (gpx.size() - segmentEnd)) / (1024.0 * 1024.0);
+}
+
+// Streaming GPX reader vs the pugixml XPath reader on the sample track repeated 100 times
+bool benchGpxParse() {
+    const int repeats = 100;
+    const char* scaledPath = "gpx_parse_bench.gpx";
+    double megabytes = writeScaledGpx(scaledPath, repeats);
+    if (megabytes == 0.0) {
+        return false;
+    }
+
+    // An untimed document read measures the DOM peak through the counting allocator and leaves the
+    // file in the OS cache for both parsers
+    Track streamed, document;
+    pugi::set_memory_management_functions(countingAllocate, countingDeallocate);
+    bool documentOk = ReadGpxDocument(scaledPath, document);
+    pugi::set_memory_management_functions(std::malloc, std::free);
+
+    // Alternating timed runs with the default allocator on both sides; the best of each is reported
+    const int rounds = 3;
+    bool streamedOk = true;
+    double streamingMs = 0.0, documentMs = 0.0;
+    for (int round = 0; round < rounds; ++round) {
+        streamed = Track();
+        auto start = std::chrono::steady_clock::now();
+        streamedOk = ReadGpxStreaming(scaledPath, streamed) && streamedOk;
+        double ms = elapsedMs(start);
+        streamingMs = round == 0 ? ms : std::min(streamingMs, ms);
+
+        document = Track();
+        start = std::chrono::steady_clock::now();
+        documentOk = ReadGpxDocument(scaledPath, document) && documentOk;
+        ms = elapsedMs(start);
+        documentMs = round == 0 ? ms : std::min(documentMs, ms);
+    }
+    std::remove(scaledPath);
+
+    size_t arrayBytes = streamed.Size() * (sizeof(int64_t) + 2 * sizeof(double) + TRACK_CHANNEL_COUNT * sizeof(float));
+    bool identical = sameTracks(streamed, document);
+    std::printf("gpx-parse: %s x%d, %.1f MB, %zu points, best of %d warm runs\n", GPX_PATH, repeats, megabytes,
+        streamed.Size(), rounds);
+    std::printf("  streaming:      %8.1f ms (%.0f MB/s), %.1f MB of point arrays\n", streamingMs, megabytes * 1000.0 / streamingMs, arrayBytes / (1024.0 * 1024.0));
+    std::printf("  pugixml xpath:  %8.1f ms (%.0f MB/s), %.1f MB DOM peak\n", documentMs, megabytes * 1000.0 / documentMs, pugiPeakBytes / (1024.0 * 1024.0));
+    std::printf("  speedup %.1fx, results %s\n", documentMs / streamingMs, identical ? "identical" : "DIFFER");
+    return streamedOk && documentOk && identical && streamed.Size() > 0;
+}
+
+// Time-range slicing of the columnar track against a linear scan, averaging heart rate per window
+bool benchTrackSlice() {
+    Track track;
+    if (!ReadGpx(GPX_PATH, track) || !track.IsTimeOrdered()) {
+        return false;
+    }
+
+    const char* channelNames[TRACK_CHANNEL_COUNT] = { "elevation", "heart rate", "cadence", "temperature" };
+    std::printf("track-slice: %zu points over %.1f min, channels:", track.Size(),
+        (track.GetTimes().back() - track.GetTimes().front()) / 60000.0);
+    for (int channel = 0; channel < TRACK_CHANNEL_COUNT; ++channel) {
+        if (track.HasChannel(static_cast<Track_Channel>(channel))) {
+            std::printf(" %s", channelNames[channel]);
+        }
+    }
+    std::printf("\n");
+
+    // Random one minute windows
+    const int windowCount = 100000;
+    const int64_t windowMs = 60000;
+    int64_t startTime = track.GetTimes().front();
+    int64_t span = track.GetTimes().back() - startTime;
+    std::vector<int64_t> windowStarts(windowCount);
+    unsigned int seed = 12345u;
+    for (int64_t& windowStart : windowStarts) {
+        seed = seed * 1664525u + 1013904223u;
+        windowStart = startTime + static_cast<int64_t>(static_cast<double>(seed >> 8) / (1u << 24) * span);
+    }
+
+    auto averageHeartRate = [](const float* heartRates, size_t count) {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += heartRates[i];
+        }
+        return count > 0 ? sum / count : 0.0;
+    };
+
+    const std::vector<int64_t>& times = track.GetTimes();
+    const std::vector<float>& heartRates = track.GetChannel(CHANNEL_HEART_RATE);
+    std::vector<double> scanned(windowCount), sliced(windowCount);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < windowCount; ++i) {
+        size_t first = 0;
+        while (first < times.size() && times[first] < windowStarts[i]) {
+            ++first;
+        }
+        size_t last = first;
+        while (last < times.size() && times[last] < windowStarts[i] + windowMs) {
+            ++last;
+        }
+        scanned[i] = averageHeartRate(heartRates.data() + first, last - first);
+    }
+    double scanMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < windowCount; ++i) {
+        TrackSlice slice = track.SliceByTime(windowStarts[i], windowStarts[i] + windowMs);
+        sliced[i] = averageHeartRate(slice.Channel(CHANNEL_HEART_RATE), slice.Size());
+    }
+    double sliceMs = elapsedMs(start);
+
+    bool identical = scanned == sliced;
+    std::printf("  %d one-minute windows, mean heart rate per window\n", windowCount);
+    std::printf("  linear scan:   %8.2f ms (%.0f ns/window)\n", scanMs, scanMs * 1e6 / windowCount);
+    std::printf("  SliceByTime:   %8.2f ms (%.0f ns/window), results %s\n", sliceMs, sliceMs * 1e6 / windowCount, identical ? "identical" : "DIFFER");
+    return identical;
+}
+
+// Loading a route from XML vs from its binary sidecar, for the sample track and 100 copies of it
+bool benchTrackCache() {
+    const char* scaledPath = "track_cache_bench.gpx";
+    const int repeatCounts[] = { 1, 100 };
+    bool success = true;
+
+    for (int repeats : repeatCounts) {
+        double megabytes = writeScaledGpx(scaledPath, repeats);
+        if (megabytes == 0.0) {
+            return false;
+        }
+        std::string cachePath = TrackCachePath(scaledPath);
+        std::remove(cachePath.c_str());
+
+        // Cold: parse and project, then write the sidecar as Path does on a miss
+        ProjectedTrack parsed;
+        auto start = std::chrono::steady_clock::now();
+        bool parsedOk = ReadGpx(scaledPath, parsed.track);
+        ProjectTrack(parsed);
+        double parseMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        bool writtenOk = WriteTrackCache(scaledPath, parsed);
+        double writeMs = elapsedMs(start);
+
+        ProjectedTrack cached;
+        start = std::chrono::steady_clock::now();
+        bool cachedOk = LoadTrackCache(scaledPath, cached);
+        double cachedMs = elapsedMs(start);
+
+        std::ifstream cacheFile(cachePath, std::ios::binary | std::ios::ate);
+        double cacheMegabytes = static_cast<double>(cacheFile.tellg()) / (1024.0 * 1024.0);
+        cacheFile.close();
+
+        bool identical = cachedOk && sameTracks(parsed.track, cached.track) && sameColumn(parsed.projected, cached.projected);
+        std::printf("track-cache: x%d, %zu points, %.2f MB GPX, %.2f MB cache\n", repeats, parsed.track.Size(), megabytes, cacheMegabytes);
+        std::printf("  parse + project: %8.2f ms\n", parseMs);
+        std::printf("  write cache:     %8.2f ms\n", writeMs);
+        std::printf("  cached load:     %8.2f ms (%.0fx faster), results %s\n", cachedMs, parseMs / cachedMs, identical ? "identical" : "DIFFER");
+        success = success && parsedOk && writtenOk && identical;
+
+        std::remove(cachePath.c_str());
+        std::remove(scaledPath);
+    }
+    return success;
+}
+
+// Vertices drawn for the GPX path in full vs culled vs culled with per-range simplification levels
+bool benchPathLOD() {
+    Terrain terrain{ TerrainOptions() };
+    Path path;
+    if (!terrain.LoadHeightmap(HEIGHTMAP_PATH) || !path.Load(GPX_PATH)) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    path.PlaceOnTerrain(terrain);
+    double placeMs = elapsedMs(start);
+
+    const std::vector<glm::vec3>& points = path.GetPoints();
+    const PathLOD& lod = path.GetLOD();
+    const std::vector<PathLOD::Range>& ranges = lod.GetRanges();
+    const std::vector<unsigned int>& indices = lod.GetIndices();
+    std::printf("path-lod: %zu points, %zu ranges, %d levels, %zu indices (place + build %.2f ms)\n",
+        points.size(), ranges.size(), PATH_LOD_LEVEL_COUNT, indices.size(), placeMs);
+
+    // Every dropped point must lie within its level's tolerance of the simplified strip
+    bool withinTolerance = true;
+    std::printf("  %-8s %10s %12s %12s\n", "level", "tolerance", "vertices", "max error");
+    for (int level = 0; level < PATH_LOD_LEVEL_COUNT; ++level) {
+        unsigned int vertices = 0;
+        float maxError = 0.0f;
+        for (size_t r = 0; r < ranges.size(); ++r) {
+            const PathLOD::Strip& strip = lod.GetStrip(static_cast<int>(r), level);
+            vertices += strip.indexCount;
+            for (unsigned int k = 1; k < strip.indexCount; ++k) {
+                unsigned int a = indices[strip.firstIndex + k - 1];
+                unsigned int b = indices[strip.firstIndex + k];
+                for (unsigned int i = a + 1; i < b; ++i) {
+                    maxError = std::max(maxError, DistanceToSegment(points[i], points[a], points[b]));
+                }
+            }
+        }
+        withinTolerance = withinTolerance && maxError <= PathLOD::GetLevelTolerance(level) + 1e-4f;
+        std::printf("  %-8d %10.3f %12u %12.4f\n", level, PathLOD::GetLevelTolerance(level), vertices, maxError);
+    }
+
+    // Cameras following the path from behind, plus one overview from high above the terrain centre
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), BENCH_VIEWPORT_WIDTH / BENCH_VIEWPORT_HEIGHT, 0.1f, 1000.0f);
+    unsigned long long totalCulled = 0, totalLOD = 0;
+    double selectMs = 0.0;
+    int poses = 0;
+    std::printf("  %-28s %12s %12s %12s\n", "camera", "full", "culled", "culled+lod");
+    for (int pose = 0; pose <= 8; ++pose) {
+        glm::vec3 position, target;
+        if (pose < 8) {
+            size_t i = points.size() * pose / 8;
+            size_t ahead = std::min(i + 20, points.size() - 1);
+            glm::vec3 direction = points[ahead] - points[i];
+            direction.y = 0.0f;
+            direction = glm::length(direction) > 0.0f ? glm::normalize(direction) : glm::vec3(1.0f, 0.0f, 0.0f);
+            position = points[i] - direction * 30.0f + glm::vec3(0.0f, 15.0f, 0.0f);
+            target = points[i];
+        }
+        else {
+            target = glm::vec3(terrain.GetWidth() * 0.5f, 0.0f, terrain.GetHeight() * 0.5f);
+            position = target + glm::vec3(0.0f, 600.0f, 400.0f);
+        }
+        glm::mat4 view = glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+        Frustum frustum(projection * view);
+        TerrainLODView lodView = MakeTerrainLODView(position, glm::radians(45.0f), BENCH_VIEWPORT_HEIGHT);
+
+        std::vector<PathLOD::Strip> strips;
+        PathLODStats culled = lod.Select(frustum, lodView, false, strips);
+        strips.clear();
+        start = std::chrono::steady_clock::now();
+        PathLODStats selected = lod.Select(frustum, lodView, true, strips);
+        selectMs += elapsedMs(start);
+
+        char label[64];
+        if (pose < 8) {
+            std::snprintf(label, sizeof(label), "follow %d/8 (%.0f, %.0f)", pose, position.x, position.z);
+        }
+        else {
+            std::snprintf(label, sizeof(label), "overview (%.0f, %.0f)", position.x, position.z);
+        }
+        std::printf("  %-28s %12zu %12u %12u\n", label, points.size(), culled.drawnVertices, selected.drawnVertices);
+        totalCulled += culled.drawnVertices;
+        totalLOD += selected.drawnVertices;
+        ++poses;
+    }
+
+    std::printf("  average vertices: full %zu, culled %llu (%.1f%%), culled+lod %llu (%.1f%%)\n",
+        points.size(), totalCulled / poses, 100.0 * totalCulled / (static_cast<double>(points.size()) * poses),
+        totalLOD / poses, 100.0 * totalLOD / (static_cast<double>(points.size()) * poses));
+    std::printf("  level selection: %.3f ms per frame, dropped points %s their level tolerance\n",
+        selectMs / poses, withinTolerance ? "within" : "EXCEED");
+    return withinTolerance;
+}
+
+// Trail bookkeeping of the path tracer: the point cap in both overflow modes, the simplification
+// tolerance and pending limit, and the cost of simplifying a long walk with the default settings
+bool benchPathTracer() {
+    const size_t maxPoints = 64;
+    const size_t total = maxPoints * 3 + 5;
+    // Off any straight line, so a tolerance of 0 and the default one both keep every point
+    auto pointAt = [](size_t i) { return glm::vec3(static_cast<float>(i), 0.0f, static_cast<float>(i % 3)); };
+
+    // Dropping the oldest keeps the newest maxPoints points in order across the wrap of the ring
+    PathTrail ring(maxPoints, OVERFLOW_DROP_OLDEST, 0.0f);
+    bool ringCapped = true;
+    for (size_t i = 0; i < total; ++i) {
+        ring.AddPoint(pointAt(i));
+        ringCapped = ringCapped && ring.GetCount() == std::min(i + 1, maxPoints);
+    }
+    std::vector<glm::vec3> points;
+    ring.GetPoints(points);
+    bool ringOrdered = ring.GetHead() != 0 && points.size() == maxPoints;
+    for (size_t k = 0; ringOrdered && k < maxPoints; ++k) {
+        ringOrdered = points[k] == pointAt(total - maxPoints + k)
+            && ring.GetStorage()[(ring.GetHead() + k) % maxPoints] == points[k];
+    }
+
+    // Decimating thins the older half each time the cap is hit and keeps the newest half untouched
+    PathTrail decimated(maxPoints, OVERFLOW_DECIMATE, 0.0f);
+    const size_t olderHalf = maxPoints / 2;
+    const size_t afterDecimation = maxPoints - olderHalf + (olderHalf + 1) / 2 + 1;
+    bool decimatedCapped = true;
+    size_t decimations = 0;
+    for (size_t i = 0; i < total; ++i) {
+        decimated.AddPoint(pointAt(i));
+        decimatedCapped = decimatedCapped && decimated.GetCount() <= maxPoints;
+        if (decimated.GetStats().decimations != decimations) {
+            decimations = decimated.GetStats().decimations;
+            decimatedCapped = decimatedCapped && decimated.GetCount() == afterDecimation;
+        }
+    }
+    decimated.GetPoints(points);
+    size_t newest = maxPoints - olderHalf;
+    bool decimatedOrdered = decimations > 0 && decimated.GetHead() == 0 && points.size() > newest
+        && points.front() == pointAt(0) && points.back() == pointAt(total - 1);
+    for (size_t k = 1; decimatedOrdered && k < points.size(); ++k) {
+        decimatedOrdered = points[k].x > points[k - 1].x;
+    }
+    for (size_t k = 0; decimatedOrdered && k < newest; ++k) {
+        decimatedOrdered = points[points.size() - 1 - k] == pointAt(total - 1 - k);
+    }
+
+    // Kept vertices are a subsequence of the raw points; returns the raw index of each, or an empty
+    // vector when they are not
+    auto keptIndices = [](const std::vector<glm::vec3>& raw, const std::vector<glm::vec3>& kept) {
+        std::vector<size_t> found;
+        for (size_t i = 0; i < raw.size() && found.size() < kept.size(); ++i) {
+            if (raw[i] == kept[found.size()]) {
+                found.push_back(i);
+            }
+        }
+        if (found.size() != kept.size()) {
+            found.clear();
+        }
+        return found;
+    };
+
+    // Every dropped point of a wandering walk lies within the tolerance of the segment that replaced it
+    unsigned int seed = 12345u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+    glm::vec3 position(0.0f);
+    float heading = 0.0f;
+    auto wander = [&]() {
+        heading += (random() - 0.5f) * 0.2f;
+        position += glm::vec3(std::cos(heading), (random() - 0.5f) * 0.02f, std::sin(heading)) * 0.5f;
+        return position;
+    };
+    std::vector<glm::vec3> raw(20000);
+    PathTrail simplified;
+    for (glm::vec3& point : raw) {
+        point = wander();
+        simplified.AddPoint(point);
+    }
+    simplified.GetPoints(points);
+    std::vector<size_t> kept = keptIndices(raw, points);
+    float maxError = 0.0f;
+    for (size_t k = 1; k < kept.size(); ++k) {
+        for (size_t i = kept[k - 1] + 1; i < kept[k]; ++i) {
+            maxError = std::max(maxError, DistanceToSegment(raw[i], raw[kept[k - 1]], raw[kept[k]]));
+        }
+    }
+    bool simplifiedWithinTolerance = !kept.empty() && kept.front() == 0 && kept.back() == raw.size() - 1
+        && maxError <= simplified.GetTolerance() + 1e-5f;
+
+    // On a straight line nothing strays, so only PATH_TRACER_MAX_PENDING ends a segment
+    raw.resize(PATH_TRACER_MAX_PENDING * 3 + 1);
+    PathTrail straight;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        raw[i] = glm::vec3(0.5f * i, 0.0f, 0.0f);
+        straight.AddPoint(raw[i]);
+    }
+    straight.GetPoints(points);
+    kept = keptIndices(raw, points);
+    bool pendingFlushed = kept.size() == 4;
+    for (size_t k = 1; pendingFlushed && k < kept.size(); ++k) {
+        pendingFlushed = kept[k] - kept[k - 1] == PATH_TRACER_MAX_PENDING;
+    }
+
+    // A million points of a wandering walk at the default cap and tolerance
+    const size_t walkPoints = 1000000;
+    PathTrail walk;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < walkPoints; ++i) {
+        walk.AddPoint(wander());
+    }
+    double walkMs = elapsedMs(start);
+
+    std::printf("path-tracer: cap %zu, %zu points per overflow mode\n", maxPoints, total);
+    std::printf("  drop oldest: count %s, order across the wrap %s\n", ringCapped ? "capped" : "WRONG", ringOrdered ? "kept" : "BROKEN");
+    std::printf("  decimate:    count %s, %zu decimations, order and newest half %s\n", decimatedCapped ? "capped" : "WRONG",
+        decimations, decimatedOrdered ? "kept" : "BROKEN");
+    std::printf("  simplified:  %zu of %zu points kept, max error %.4f of tolerance %.2f\n", simplified.GetCount(),
+        simplified.GetStats().pointsAdded, maxError, simplified.GetTolerance());
+    std::printf("  straight:    %zu points, segments %s at %zu pending points\n", raw.size(),
+        pendingFlushed ? "flushed" : "NOT flushed", PATH_TRACER_MAX_PENDING);
+    std::printf("  walk: %zu points in %.2f ms (%.1f ns/point), %zu vertices kept, %zu decimations\n", walkPoints, walkMs,
+        walkMs * 1e6 / walkPoints, walk.GetStats().verticesAdded, walk.GetStats().decimations);
+    return ringCapped && ringOrdered && decimatedCapped && decimatedOrdered && simplifiedWithinTolerance && pendingFlushed;
+}
+
+// Writes a width x height test image with smooth and noisy channels as an uncompressed TGA, top row first
+bool writeTestImage(const char* path, int width, int height, bool alpha) {
+    unsigned char header[18] = {};
+    header[2] = 2;  // Uncompressed true colour
+    header[12] = static_cast<unsigned char>(width);
+    header[13] = static_cast<unsigned char>(width >> 8);
+    header[14] = static_cast<unsigned char>(height);
+    header[15] = static_cast<unsigned char>(height >> 8);
+    header[16] = alpha ? 32 : 24;
+    header[17] = alpha ? 0x28 : 0x20;  // Top-left origin, 8 alpha bits
+
+    int channels = alpha ? 4 : 3;
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * channels);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            // Stored as BGR(A)
+            unsigned char* pixel = &pixels[(static_cast<size_t>(y) * width + x) * channels];
+            pixel[2] = static_cast<unsigned char>(x * 255 / std::max(width - 1, 1));
+            pixel[1] = static_cast<unsigned char>(255 - y * 255 / std::max(height - 1, 1));
+            pixel[0] = static_cast<unsigned char>((x * 37 + y * 91) * 7);
+            if (alpha) {
+                pixel[3] = static_cast<unsigned char>(x * 20 + y * 60);
+            }
+        }
+    }
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    return static_cast<bool>(out);
+}
+
+// The KTX writer and loader on small odd-sized images, and loading the terrain texture compressed vs decoded
+bool benchTextureCompression() {
+    const char* imagePath = "texture_compression_bench.tga";
+    const char* ktxPath = "texture_compression_bench.ktx";
+    const char* flippedPath = "texture_compression_bench_flipped.ktx";
+    bool success = true;
+
+    // Header, level count and level sizes of a 13x7 image with and without alpha
+    const int width = 13, height = 7;
+    std::printf("texture-compression: %dx%d test images, BC1 without alpha and BC3 with\n", width, height);
+    for (int alpha = 0; alpha < 2; ++alpha) {
+        if (!writeTestImage(imagePath, width, height, alpha != 0) || !CompressTexture(imagePath, ktxPath)) {
+            success = false;
+            continue;
+        }
+        GLenum format = alpha ? COMPRESSED_RGBA_S3TC_DXT5 : COMPRESSED_RGB_S3TC_DXT1;
+        size_t blockSize = alpha ? 16 : 8;
+
+        KTXHeader header;
+        std::ifstream file(ktxPath, std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        const char orientation[] = "KTXorientation\0S=r,T=d";
+        char keyValue[sizeof(orientation)] = {};
+        file.seekg(sizeof(header) + sizeof(uint32_t));
+        file.read(keyValue, sizeof(keyValue));
+        file.close();
+        bool headerOk = std::memcmp(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) == 0
+            && header.endianness == KTX_ENDIANNESS && header.glInternalFormat == format
+            && header.glBaseInternalFormat == static_cast<uint32_t>(alpha ? GL_RGBA : GL_RGB)
+            && header.pixelWidth == static_cast<uint32_t>(width) && header.pixelHeight == static_cast<uint32_t>(height)
+            && header.numberOfFaces == 1 && header.numberOfMipmapLevels == 4
+            && std::memcmp(keyValue, orientation, sizeof(orientation)) == 0;
+
+        // 13x7, 6x3, 3x1 and 1x1, each rounded up to whole 4x4 blocks
+        ImageData image;
+        bool loaded = LoadCompressedTexture(ktxPath, false, image);
+        const size_t expectedSizes[] = { 4 * 2 * blockSize, 2 * 1 * blockSize, blockSize, blockSize };
+        bool levelsOk = loaded && image.width == width && image.height == height && image.channels == (alpha ? 4 : 3)
+            && image.compressedFormat == format && image.levelSizes.size() == 4
+            && image.pixels.size() == expectedSizes[0] + expectedSizes[1] + expectedSizes[2] + expectedSizes[3];
+        for (size_t level = 0; levelsOk && level < 4; ++level) {
+            levelsOk = image.levelSizes[level] == expectedSizes[level];
+        }
+        std::printf("  %dx%d %s: header %s, %zu levels %s\n", width, height, alpha ? "BC3" : "BC1",
+            headerOk ? "valid" : "INVALID", image.levelSizes.size(), levelsOk ? "sized correctly" : "WRONG");
+        success = success && headerOk && levelsOk;
+    }
+
+    // Flipping blocks at load time must give the bytes of compressing the flipped image, for every
+    // height a level can be flipped at: whole block rows and the single partial rows of 2 and 1
+    const int flipHeights[] = { 4, 2, 1 };
+    for (int flipHeight : flipHeights) {
+        for (int alpha = 0; alpha < 2; ++alpha) {
+            ImageData flippedBlocks, flippedImage, unflippedBlocks, unflippedImage;
+            bool ok = writeTestImage(imagePath, width, flipHeight, alpha != 0)
+                && CompressTexture(imagePath, ktxPath) && CompressTexture(imagePath, flippedPath, true)
+                && LoadCompressedTexture(ktxPath, true, flippedBlocks) && LoadCompressedTexture(flippedPath, true, flippedImage)
+                && LoadCompressedTexture(flippedPath, false, unflippedBlocks) && LoadCompressedTexture(ktxPath, false, unflippedImage);
+            bool identical = ok && flippedBlocks.pixels == flippedImage.pixels && unflippedBlocks.pixels == unflippedImage.pixels;
+            std::printf("  flip %dx%d %s: block flip and flipped encode %s\n", width, flipHeight, alpha ? "BC3" : "BC1",
+                identical ? "identical" : "DIFFER");
+            success = success && identical;
+        }
+    }
+
+    // A partial block row below full ones cannot be flipped block by block and must be refused
+    ImageData refused;
+    bool refusedOk = writeTestImage(imagePath, width, 6, false) && CompressTexture(imagePath, ktxPath)
+        && !LoadCompressedTexture(ktxPath, true, refused);
+    std::printf("  flip %dx6: %s\n", width, refusedOk ? "refused as expected" : "NOT refused");
+    success = success && refusedOk;
+
+    // The terrain texture compressed once, then loaded from KTX and decoded from PNG
+    const char* texturePath = "assets/textures/terrain_texture.png";
+    if (CompressTexture(texturePath, ktxPath)) {
+        ImageData decoded, compressed;
+        auto start = std::chrono::steady_clock::now();
+        bool decodedOk = LoadImageData(texturePath, true, decoded, 4);
+        double decodeMs = elapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        bool compressedOk = LoadCompressedTexture(ktxPath, false, compressed);
+        double compressedMs = elapsedMs(start);
+        std::printf("  %s: PNG decode %.2f ms (%zu KB RGBA), KTX load %.2f ms (%zu KB with mips)\n", texturePath,
+            decodeMs, decoded.pixels.size() / 1024, compressedMs, compressed.pixels.size() / 1024);
+        success = success && decodedOk && compressedOk;
+    }
+    else {
+        success = false;
+    }
+
+    std::remove(imagePath);
+    std::remove(ktxPath);
+    std::remove(flippedPath);
+    return success;
+}
+
+// Fixed-step walking over a synthetic surface: frame splits, interpolation, stalls and trail spacing
+bool benchSimulation() {
+    const glm::vec2 extent(511.0f);
+    auto groundHeight = [](float x, float z) { return 4.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f); };
+    const glm::vec3 start(256.0f, groundHeight(256.0f, 256.0f) + SCENE_CAMERA_HEIGHT, 256.0f);
+    const uint8_t keys = INPUT_KEY_FORWARD | INPUT_KEY_RIGHT;
+    const float totalSeconds = 10.0f;
+
+    unsigned int seed = 12345u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+
+    // The same walk split into frames of different lengths; frames stay below the stall clamp
+    struct Split {
+        const char* name;
+        std::function<float()> nextDelta;
+    };
+    const Split splits[] = {
+        { "60 Hz", []() { return SIMULATION_TIMESTEP; } },
+        { "144 Hz", []() { return 1.0f / 144.0f; } },
+        { "24 Hz", []() { return 1.0f / 24.0f; } },
+        { "random", [&random]() { return random() * 0.1f; } },
+    };
+    glm::vec3 reference(0.0f);
+    long long referenceSteps = 0;
+    float maxStepLength = 0.0f;
+    std::vector<glm::vec3> trailPoints;
+    bool splitsAgree = true;
+    bool interpolationInRange = true;
+    std::printf("simulation: %.0f s walking diagonally over a %.0fx%.0f sine surface\n", totalSeconds, extent.x, extent.y);
+    for (const Split& split : splits) {
+        Camera camera(start);
+        PathTrail trail(PATH_TRACER_DEFAULT_MAX_POINTS, OVERFLOW_DECIMATE, 0.0f);
+        Simulation simulation(groundHeight, extent, trail);
+        simulation.Reset(camera);
+
+        double elapsed = 0.0;
+        int frames = 0;
+        float interpolation = 0.0f;
+        while (elapsed < totalSeconds) {
+            float deltaTime = static_cast<float>(std::min<double>(split.nextDelta(), totalSeconds - elapsed));
+            elapsed += deltaTime;
+            glm::vec3 before = camera.Position;
+            float interpolationBefore = interpolation;
+            int steps = simulation.Advance({ deltaTime, 0.0f, 0.0f, keys }, camera);
+            interpolation = simulation.GetInterpolation();
+            interpolationInRange = interpolationInRange && interpolation >= 0.0f && interpolation < 1.0f;
+            // With the interpolation unchanged the rendered position moved by exactly one step
+            if (steps == 1 && frames > 0 && std::abs(interpolation - interpolationBefore) < 1e-4f) {
+                maxStepLength = std::max(maxStepLength, glm::length(camera.Position - before));
+            }
+            ++frames;
+        }
+
+        // Float rounding of the accumulator may leave one step still pending, which the interpolation covers
+        float difference = 0.0f;
+        if (&split == &splits[0]) {
+            reference = camera.Position;
+            referenceSteps = simulation.GetStepCount();
+            trail.GetPoints(trailPoints);
+        }
+        else {
+            difference = glm::length(camera.Position - reference);
+            splitsAgree = splitsAgree && difference < 1e-3f && std::abs(simulation.GetStepCount() - referenceSteps) <= 1;
+        }
+        std::printf("  %-6s: %5d frames, %lld steps, final position (%.3f, %.3f, %.3f), %.5f from 60 Hz\n", split.name,
+            frames, simulation.GetStepCount(), camera.Position.x, camera.Position.y, camera.Position.z, difference);
+    }
+
+    // Consecutive trail points lie more than the spacing apart, by at most one step
+    float minGap = trailPoints.size() > 1 ? glm::length(trailPoints[1] - trailPoints[0]) : 0.0f;
+    float maxGap = minGap;
+    for (size_t i = 1; i < trailPoints.size(); ++i) {
+        float gap = glm::length(trailPoints[i] - trailPoints[i - 1]);
+        minGap = std::min(minGap, gap);
+        maxGap = std::max(maxGap, gap);
+    }
+    bool trailSpaced = trailPoints.size() > 2 && minGap > SIMULATION_TRAIL_SPACING
+        && maxGap <= SIMULATION_TRAIL_SPACING + maxStepLength + 1e-4f;
+
+    // A long stall runs at most SIMULATION_MAX_STEPS steps and leaves the interpolation in range
+    Camera camera(start);
+    PathTrail trail(PATH_TRACER_DEFAULT_MAX_POINTS, OVERFLOW_DECIMATE, 0.0f);
+    Simulation simulation(groundHeight, extent, trail);
+    simulation.Reset(camera);
+    int stallSteps = simulation.Advance({ 5.0f, 0.0f, 0.0f, keys }, camera);
+    float stallInterpolation = simulation.GetInterpolation();
+    bool stallCapped = stallSteps > 0 && stallSteps <= SIMULATION_MAX_STEPS
+        && stallInterpolation >= 0.0f && stallInterpolation < 1.0f;
+
+    // A million steps at 60 Hz; the walker ends up pressed against the edge of the extent
+    const int timedFrames = 1000000;
+    auto timer = std::chrono::steady_clock::now();
+    for (int i = 0; i < timedFrames; ++i) {
+        simulation.Advance({ SIMULATION_TIMESTEP, 0.0f, 0.0f, keys }, camera);
+    }
+    double stepMs = elapsedMs(timer);
+
+    std::printf("  splits: final positions %s, interpolation %s\n", splitsAgree ? "agree" : "DIFFER",
+        interpolationInRange ? "within [0, 1)" : "OUT OF RANGE");
+    std::printf("  trail: %zu points, gaps %.3f to %.3f for spacing %.2f and steps up to %.3f: %s\n", trailPoints.size(),
+        minGap, maxGap, SIMULATION_TRAIL_SPACING, maxStepLength, trailSpaced ? "spaced" : "WRONG");
+    std::printf("  stall: 5 s frame ran %d steps of at most %d: %s\n", stallSteps, SIMULATION_MAX_STEPS,
+        stallCapped ? "capped" : "NOT capped");
+    std::printf("  steps: %lld in %.2f ms (%.1f ns/step)\n", simulation.GetStepCount(), stepMs,
+        stepMs * 1e6 / simulation.GetStepCount());
+    return splitsAgree && interpolationInRange && trailSpaced && stallCapped;
+}
+
+struct Benchmark {
+    const char* name;
+    bool (*run)();
+};
+
+const Benchmark BENCHMARKS[] = {
+    { "terrain-lod", benchTerrainLOD },
+    { "terrain-compact", benchTerrainCompact },
+    { "terrain-topology", benchTerrainTopology },
+    { "terrain-normals", benchTerrainNormals },
+    { "terrain-sampling", benchTerrainSampling },
+    { "terrain-tiles", benchTerrainTiles },
+    { "asset-loading", benchAssetLoading },
+    { "gpx-parse", benchGpxParse },
+    { "track-slice", benchTrackSlice },
+    { "track-cache", benchTrackCache },
+    { "path-lod", benchPathLOD },
+    { "path-tracer", benchPathTracer },
+    { "texture-compression", benchTextureCompression },
+    { "simulation", benchSimulation },
+};
+
+} // namespace
+
+int RunBenchmarks(const std::string& name) {
+    if (name == "list") {
+        for (const Benchmark& benchmark : BENCHMARKS) {
+            std::cout << benchmark.name << '\n';
+        }
+        return 0;
+    }
+
+    bool found = false;
+    bool success = true;
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        if (name == "all" || name == benchmark.name) {
+            found = true;
+            if (!benchmark.run()) {
+                std::cerr << "ERROR::BENCHMARK::FAILED: " << benchmark.name << '\n';
+                success = false;
+            }
+        }
+    }
+    if (!found) {
+        std::cerr << "ERROR::BENCHMARK::UNKNOWN: " << name << '\n';
+        return 1;
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <string>
+
+// Runs the named headless CPU benchmark ("all" runs every one, "list" prints the names).
+// Returns a process exit code.
+int RunBenchmarks(const std::string& name);
+
+#endif
@@ -64,6 +64,24 @@ void Camera::ProcessMouseScroll(float yoffset)
         Zoom = 80.0f;
 }
 
+void Camera::LookAt(const glm::vec3& target)
+{
+    glm::vec3 direction = target - Position;
+    if (glm::dot(direction, direction) <= 0.0f)
+        return;
+    direction = glm::normalize(direction);
+    Yaw = glm::degrees(glm::atan(direction.z, direction.x));
+    Pitch = glm::clamp(glm::degrees(glm::asin(direction.y)), -89.0f, 89.0f);
+    updateCameraVectors();
+}
+
+void Camera::SetOrientation(float yaw, float pitch)
+{
+    Yaw = yaw;
+    Pitch = pitch;
+    updateCameraVectors();
+}
+
 void Camera::updateCameraVectors()
 {
     // Calculate the new Front vector
@@ -50,6 +50,12 @@ public:
     // Processes input received from a mouse scroll-wheel event
     void ProcessMouseScroll(float yoffset);
 
+    // Turns the camera towards a point; pitch is limited like mouse movement
+    void LookAt(const glm::vec3& target);
+
+    // Sets yaw and pitch in degrees, e.g. to restore a saved pose
+    void SetOrientation(float yaw, float pitch);
+
 private:
     // Calculates the front vector from the Camera's Euler Angles
     void updateCameraVectors();
@@ -0,0 +1,86 @@
+#include "FileUtils.h"
+#include <sys/stat.h>
+#include <cstdio>
+#include <fstream>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+typedef struct _stat64 FileInfo;
+
+bool getFileInfo(const std::string& path, FileInfo& info) {
+    return _stat64(path.c_str(), &info) == 0;
+}
+#else
+typedef struct stat FileInfo;
+
+bool getFileInfo(const std::string& path, FileInfo& info) {
+    return stat(path.c_str(), &info) == 0;
+}
+#endif
+
+} // namespace
+
+bool GetFileStamp(const std::string& path, uint64_t& size, int64_t& modified) {
+    FileInfo info;
+    if (!getFileInfo(path, info)) {
+        return false;
+    }
+    size = static_cast<uint64_t>(info.st_size);
+    modified = static_cast<int64_t>(info.st_mtime);
+    return true;
+}
+
+bool GetFileModifiedTime(const std::string& path, int64_t& modified) {
+    uint64_t size;
+    return GetFileStamp(path, size, modified);
+}
+
+bool FileExists(const std::string& path) {
+    FileInfo info;
+    return getFileInfo(path, info);
+}
+
+bool MakeDirectory(const std::string& path) {
+    if (FileExists(path)) {
+        return true;
+    }
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0;
+#else
+    return mkdir(path.c_str(), 0755) == 0;
+#endif
+}
+
+bool WriteFileAtomically(const std::string& path, const std::function<void(std::ostream&)>& write) {
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    write(out);
+    out.close();
+    if (out.fail()) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    // rename does not replace an existing file on Windows
+    std::remove(path.c_str());
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+uint64_t HashFnv1a(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
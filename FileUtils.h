@@ -0,0 +1,27 @@
+#ifndef FILE_UTILS_H
+#define FILE_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+// Size and modification time (seconds since the epoch) of a file; false when it does not exist
+bool GetFileStamp(const std::string& path, uint64_t& size, int64_t& modified);
+bool GetFileModifiedTime(const std::string& path, int64_t& modified);
+bool FileExists(const std::string& path);
+
+// Creates one directory level; true if the path already exists
+bool MakeDirectory(const std::string& path);
+
+// Calls write with a stream to a temporary file next to path and renames it into place once everything
+// was written, so readers never see a truncated file. On failure the temporary file is removed and path
+// keeps its previous contents, if any.
+bool WriteFileAtomically(const std::string& path, const std::function<void(std::ostream&)>& write);
+
+// 64-bit FNV-1a, continued from hash; start from FNV1A_OFFSET_BASIS
+const uint64_t FNV1A_OFFSET_BASIS = 14695981039346656037ull;
+uint64_t HashFnv1a(uint64_t hash, const void* data, size_t size);
+
+#endif
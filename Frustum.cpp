@@ -0,0 +1,59 @@
+#include "Frustum.h"
+
+Frustum::Frustum() {
+    // Degenerate planes that accept everything until Update is called
+    for (auto& plane : planes) {
+        plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+    Update(viewProjection);
+}
+
+void Frustum::Update(const glm::mat4& viewProjection) {
+    // glm is column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+    glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+    glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+    glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+    planes[0] = row3 + row0; // Left
+    planes[1] = row3 - row0; // Right
+    planes[2] = row3 + row1; // Bottom
+    planes[3] = row3 - row1; // Top
+    planes[4] = row3 + row2; // Near
+    planes[5] = row3 - row2; // Far
+
+    for (auto& plane : planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) {
+            plane /= length;
+        }
+    }
+}
+
+Frustum_Containment Frustum::Classify(const AABB& box) const {
+    Frustum_Containment result = INSIDE;
+    for (const auto& plane : planes) {
+        glm::vec3 normal(plane);
+
+        // Corner furthest along the plane normal (p-vertex) and the opposite one (n-vertex)
+        glm::vec3 positive(
+            normal.x >= 0.0f ? box.max.x : box.min.x,
+            normal.y >= 0.0f ? box.max.y : box.min.y,
+            normal.z >= 0.0f ? box.max.z : box.min.z);
+        glm::vec3 negative(
+            normal.x >= 0.0f ? box.min.x : box.max.x,
+            normal.y >= 0.0f ? box.min.y : box.max.y,
+            normal.z >= 0.0f ? box.min.z : box.max.z);
+
+        if (glm::dot(normal, positive) + plane.w < 0.0f) {
+            return OUTSIDE;
+        }
+        if (glm::dot(normal, negative) + plane.w < 0.0f) {
+            result = INTERSECTING;
+        }
+    }
+    return result;
+}
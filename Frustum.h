@@ -0,0 +1,35 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// Axis-aligned bounding box in world space
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+enum Frustum_Containment {
+    OUTSIDE,
+    INTERSECTING,
+    INSIDE
+};
+
+class Frustum {
+public:
+    Frustum();
+    // Extracts the six clip planes from a projection * view matrix
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    void Update(const glm::mat4& viewProjection);
+
+    // Classifies a box against all planes; INSIDE means no plane clips it
+    Frustum_Containment Classify(const AABB& box) const;
+    bool Intersects(const AABB& box) const { return Classify(box) != OUTSIDE; }
+
+private:
+    // Plane equations (xyz = inward normal, w = distance), order: left, right, bottom, top, near, far
+    glm::vec4 planes[6];
+};
+
+#endif
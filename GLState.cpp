@@ -0,0 +1,187 @@
+#include "GLState.h"
+
+namespace {
+
+// Tracked texture targets; index into State::textures
+const GLenum TEXTURE_TARGETS[] = { GL_TEXTURE_2D, GL_TEXTURE_BUFFER };
+const int TEXTURE_TARGET_COUNT = sizeof(TEXTURE_TARGETS) / sizeof(TEXTURE_TARGETS[0]);
+
+const GLenum CAPABILITIES[] = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_PRIMITIVE_RESTART };
+const int CAPABILITY_COUNT = sizeof(CAPABILITIES) / sizeof(CAPABILITIES[0]);
+
+// No GL object or enum has this value, so it marks state as unknown
+const GLuint UNKNOWN = 0xFFFFFFFFu;
+
+struct State {
+    GLuint program;
+    GLuint vertexArray;
+    GLuint activeUnit;
+    GLuint textures[GL_STATE_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    GLuint capabilities[CAPABILITY_COUNT];  // UNKNOWN, GL_FALSE or GL_TRUE
+    GLuint depthFunc;
+    GLuint depthMask;
+    GLuint restartIndex;
+};
+
+State unknownState() {
+    State unknown;
+    unknown.program = UNKNOWN;
+    unknown.vertexArray = UNKNOWN;
+    unknown.activeUnit = UNKNOWN;
+    for (GLuint unit = 0; unit < GL_STATE_TEXTURE_UNITS; ++unit) {
+        for (int target = 0; target < TEXTURE_TARGET_COUNT; ++target) {
+            unknown.textures[unit][target] = UNKNOWN;
+        }
+    }
+    for (int i = 0; i < CAPABILITY_COUNT; ++i) {
+        unknown.capabilities[i] = UNKNOWN;
+    }
+    unknown.depthFunc = UNKNOWN;
+    unknown.depthMask = UNKNOWN;
+    unknown.restartIndex = UNKNOWN;
+    return unknown;
+}
+
+State state = unknownState();
+GLStateStats stats = { 0, 0 };
+
+int textureTargetIndex(GLenum target) {
+    for (int i = 0; i < TEXTURE_TARGET_COUNT; ++i) {
+        if (TEXTURE_TARGETS[i] == target) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int capabilityIndex(GLenum capability) {
+    for (int i = 0; i < CAPABILITY_COUNT; ++i) {
+        if (CAPABILITIES[i] == capability) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// True when the cached value already matches; otherwise records it and counts the call as issued
+bool unchanged(GLuint& cached, GLuint value) {
+    if (cached == value) {
+        ++stats.elided;
+        return true;
+    }
+    cached = value;
+    ++stats.issued;
+    return false;
+}
+
+void activeTexture(GLuint unit) {
+    if (!unchanged(state.activeUnit, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+} // namespace
+
+void ResetGLStateCache() {
+    state = unknownState();
+}
+
+void UseProgram(GLuint program) {
+    if (!unchanged(state.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void BindVertexArray(GLuint vertexArray) {
+    if (!unchanged(state.vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void BindTexture(GLuint unit, GLenum target, GLuint texture) {
+    int targetIndex = textureTargetIndex(target);
+    if (unit >= GL_STATE_TEXTURE_UNITS || targetIndex < 0) {
+        activeTexture(unit);
+        glBindTexture(target, texture);
+        ++stats.issued;
+        return;
+    }
+    if (!unchanged(state.textures[unit][targetIndex], texture)) {
+        activeTexture(unit);
+        glBindTexture(target, texture);
+    }
+}
+
+void SetCapability(GLenum capability, bool enabled) {
+    int index = capabilityIndex(capability);
+    if (index >= 0 && unchanged(state.capabilities[index], enabled ? GL_TRUE : GL_FALSE)) {
+        return;
+    }
+    if (index < 0) {
+        ++stats.issued;
+    }
+    if (enabled) {
+        glEnable(capability);
+    }
+    else {
+        glDisable(capability);
+    }
+}
+
+void SetDepthFunc(GLenum func) {
+    if (!unchanged(state.depthFunc, func)) {
+        glDepthFunc(func);
+    }
+}
+
+void SetDepthMask(bool write) {
+    if (!unchanged(state.depthMask, write ? GL_TRUE : GL_FALSE)) {
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void SetPrimitiveRestartIndex(GLuint index) {
+    if (!unchanged(state.restartIndex, index)) {
+        glPrimitiveRestartIndex(index);
+    }
+}
+
+void DeleteTextures(GLsizei count, const GLuint* textures) {
+    // GL unbinds a deleted texture from every unit of the current context
+    for (GLsizei i = 0; i < count; ++i) {
+        for (GLuint unit = 0; unit < GL_STATE_TEXTURE_UNITS; ++unit) {
+            for (int target = 0; target < TEXTURE_TARGET_COUNT; ++target) {
+                if (state.textures[unit][target] == textures[i]) {
+                    state.textures[unit][target] = 0;
+                }
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+void DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays) {
+    for (GLsizei i = 0; i < count; ++i) {
+        if (state.vertexArray == vertexArrays[i]) {
+            state.vertexArray = 0;
+        }
+    }
+    glDeleteVertexArrays(count, vertexArrays);
+}
+
+void DeleteProgram(GLuint program) {
+    // A current program stays current until the next glUseProgram, so the next UseProgram must be issued
+    if (state.program == program) {
+        state.program = UNKNOWN;
+    }
+    glDeleteProgram(program);
+}
+
+const GLStateStats& GetGLStateStats() {
+    return stats;
+}
+
+void ResetGLStateStats() {
+    stats.issued = 0;
+    stats.elided = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// Cache of the GL state the renderer changes, so binding what is already bound costs no GL call.
+// All draw and upload code changes this state through these functions; a direct gl* call to the same
+// state would leave the cache wrong. Everything is unknown after ResetGLStateCache, so the next call
+// of each kind is issued.
+
+// Texture units and targets the cache tracks; binds outside them are always issued
+const GLuint GL_STATE_TEXTURE_UNITS = 16;
+
+// GL calls issued and skipped as no-ops since the last ResetGLStateStats; main resets them every frame
+struct GLStateStats {
+    unsigned int issued;
+    unsigned int elided;
+};
+
+// Call once the context is current, and after code outside the cache changed tracked state
+void ResetGLStateCache();
+
+void UseProgram(GLuint program);
+void BindVertexArray(GLuint vertexArray);
+// Selects the unit with glActiveTexture only when the bind is issued
+void BindTexture(GLuint unit, GLenum target, GLuint texture);
+
+// GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND and GL_PRIMITIVE_RESTART are cached; others are always issued
+void SetCapability(GLenum capability, bool enabled);
+void SetDepthFunc(GLenum func);
+void SetDepthMask(bool write);
+void SetPrimitiveRestartIndex(GLuint index);
+
+// Delete through these so a recycled name is not mistaken for the deleted object still being bound
+void DeleteTextures(GLsizei count, const GLuint* textures);
+void DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+void DeleteProgram(GLuint program);
+
+const GLStateStats& GetGLStateStats();
+void ResetGLStateStats();
+
+#endif
@@ -0,0 +1,501 @@
+#include "GpxReader.h"
+#include <pugixml/src/pugixml.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const size_t GPX_READ_CHUNK = 64 * 1024;
+
+// Elements inside a <trkpt> whose text is a channel value
+struct GpxChannelElement {
+    const char* name;
+    Track_Channel channel;
+};
+
+const GpxChannelElement GPX_CHANNEL_ELEMENTS[] = {
+    { "ele", CHANNEL_ELEVATION },
+    { "hr", CHANNEL_HEART_RATE },
+    { "cad", CHANNEL_CADENCE },
+    { "atemp", CHANNEL_TEMPERATURE },
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Name without its namespace prefix, e.g. "gpxtpx:hr" -> "hr"
+bool localNameEquals(const char* name, size_t length, const char* expected) {
+    const char* colon = static_cast<const char*>(std::memchr(name, ':', length));
+    if (colon) {
+        length -= colon + 1 - name;
+        name = colon + 1;
+    }
+    return std::strlen(expected) == length && std::memcmp(name, expected, length) == 0;
+}
+
+// Plain decimals with at most 15 significant digits, e.g. "68.4401650". The digits form an exact
+// integer and the power of ten is exact, so the single division rounds exactly like strtod.
+bool parseShortDecimal(const char* text, size_t length, double& value) {
+    static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    size_t i = 0;
+    bool negative = length > 0 && (text[0] == '-' || text[0] == '+');
+    if (negative) {
+        negative = text[0] == '-';
+        ++i;
+    }
+
+    int64_t mantissa = 0;
+    int digits = 0, fractionDigits = 0;
+    bool fraction = false;
+    for (; i < length; ++i) {
+        char c = text[i];
+        if (c >= '0' && c <= '9') {
+            mantissa = mantissa * 10 + (c - '0');
+            fractionDigits += fraction;
+            if (++digits > 15) {
+                return false;
+            }
+        }
+        else if (c == '.' && !fraction) {
+            fraction = true;
+        }
+        else if (isSpace(c)) {
+            break;
+        }
+        else {
+            return false;
+        }
+    }
+    for (; i < length; ++i) {
+        if (!isSpace(text[i])) {
+            return false;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    value = static_cast<double>(mantissa) / POWERS_OF_TEN[fractionDigits];
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+bool parseDouble(const char* text, size_t length, double& value) {
+    while (length > 0 && isSpace(*text)) {
+        ++text;
+        --length;
+    }
+    if (parseShortDecimal(text, length, value)) {
+        return true;
+    }
+
+    // Anything else goes through strtod, which needs a terminated string
+    char number[64];
+    if (length == 0 || length >= sizeof(number)) {
+        return false;
+    }
+    std::memcpy(number, text, length);
+    number[length] = '\0';
+    char* end;
+    value = std::strtod(number, &end);
+    return end != number;
+}
+
+// Finds an attribute by name in the inside of a start tag ("trkpt lat=\"..\" lon=\"..\"")
+bool findAttribute(const char* tag, size_t length, const char* name, double& value) {
+    const char* end = tag + length;
+    const char* p = tag;
+    while (p < end && !isSpace(*p)) {
+        ++p;
+    }
+    while (p < end) {
+        while (p < end && isSpace(*p)) {
+            ++p;
+        }
+        const char* nameStart = p;
+        while (p < end && *p != '=' && !isSpace(*p)) {
+            ++p;
+        }
+        const char* nameEnd = p;
+        while (p < end && (isSpace(*p) || *p == '=')) {
+            ++p;
+        }
+        if (p >= end || (*p != '"' && *p != '\'')) {
+            return false;
+        }
+        char quote = *p++;
+        const char* valueStart = p;
+        while (p < end && *p != quote) {
+            ++p;
+        }
+        if (localNameEquals(nameStart, nameEnd - nameStart, name)) {
+            return parseDouble(valueStart, p - valueStart, value);
+        }
+        ++p;
+    }
+    return false;
+}
+
+// Sliding window over a file; offsets are relative to the current position and stay valid across refills
+class GpxStream {
+public:
+    explicit GpxStream(std::FILE* file) : file(file), buffer(GPX_READ_CHUNK), begin(0), end(0) {
+    }
+
+    const char* Data() const { return buffer.data() + begin; }
+    size_t Available() const { return end - begin; }
+    void Advance(size_t count) { begin += count; }
+
+    // Reads another chunk, keeping the unconsumed bytes; false at end of file
+    bool Refill() {
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        size_t read = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+        end += read;
+        return read > 0;
+    }
+
+    // Makes at least count bytes available from the current position; false if the file ends first
+    bool Ensure(size_t count) {
+        while (Available() < count) {
+            if (!Refill()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Offset of the next occurrence of a byte at or after `from`, or SIZE_MAX at end of file
+    size_t Find(char c, size_t from) {
+        for (;;) {
+            if (from < Available()) {
+                const void* found = std::memchr(Data() + from, c, Available() - from);
+                if (found) {
+                    return static_cast<const char*>(found) - Data();
+                }
+                from = Available();
+            }
+            if (!Refill()) {
+                return SIZE_MAX;
+            }
+        }
+    }
+
+    // Offset just past the next occurrence of a terminator such as "-->", or SIZE_MAX at end of file
+    size_t FindEnd(const char* terminator, size_t from) {
+        size_t length = std::strlen(terminator);
+        for (;;) {
+            size_t candidate = Find(terminator[0], from);
+            if (candidate == SIZE_MAX) {
+                return SIZE_MAX;
+            }
+            if (!Ensure(candidate + length)) {
+                return SIZE_MAX;
+            }
+            if (std::memcmp(Data() + candidate, terminator, length) == 0) {
+                return candidate + length;
+            }
+            from = candidate + 1;
+        }
+    }
+
+    // Offset of the '>' closing the tag that starts at the current position, skipping quoted attribute values
+    size_t FindTagEnd() {
+        size_t from = 1;
+        for (;;) {
+            size_t close = Find('>', from);
+            if (close == SIZE_MAX) {
+                return SIZE_MAX;
+            }
+            const char* quote = firstQuote(Data() + from, Data() + close);
+            if (!quote) {
+                return close;
+            }
+            size_t quoteEnd = Find(*quote, quote - Data() + 1);
+            if (quoteEnd == SIZE_MAX) {
+                return SIZE_MAX;
+            }
+            from = quoteEnd + 1;
+        }
+    }
+
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    size_t begin, end;
+
+    static const char* firstQuote(const char* first, const char* last) {
+        const char* doubleQuote = static_cast<const char*>(std::memchr(first, '"', last - first));
+        const char* singleQuote = static_cast<const char*>(std::memchr(first, '\'', (doubleQuote ? doubleQuote : last) - first));
+        return singleQuote ? singleQuote : doubleQuote;
+    }
+};
+
+enum Gpx_Capture {
+    CAPTURE_NONE,
+    CAPTURE_TIME,
+    CAPTURE_CHANNEL
+};
+
+// Stores the text collected for <time> or a channel element in the last point
+void storeCapture(Gpx_Capture capture, Track_Channel channel, const std::string& text, Track& track) {
+    size_t point = track.Size() - 1;
+    if (capture == CAPTURE_CHANNEL) {
+        double value;
+        if (parseDouble(text.data(), text.size(), value)) {
+            track.SetValue(channel, point, static_cast<float>(value));
+        }
+    }
+    else if (capture == CAPTURE_TIME) {
+        int64_t time;
+        if (ParseGpxTime(text.data(), text.size(), time)) {
+            track.SetTime(point, time);
+        }
+    }
+}
+
+bool readGpxStream(std::FILE* file, Track& track) {
+    GpxStream stream(file);
+    bool inPoint = false;
+    Gpx_Capture capture = CAPTURE_NONE;
+    Track_Channel captureChannel = CHANNEL_ELEVATION;
+    std::string text;
+
+    for (;;) {
+        // Character data up to the next markup; only kept inside <time> and channel elements
+        size_t markup = stream.Find('<', 0);
+        if (markup == SIZE_MAX) {
+            return !inPoint;
+        }
+        if (capture != CAPTURE_NONE) {
+            text.append(stream.Data(), markup);
+        }
+        stream.Advance(markup);
+
+        if (!stream.Ensure(2)) {
+            return false;
+        }
+        char kind = stream.Data()[1];
+        if (kind == '!' || kind == '?') {
+            // Comments, processing instructions and the DOCTYPE carry no track data; CDATA is kept as text
+            stream.Ensure(9);
+            const char* terminator = ">";
+            if (kind == '?') {
+                terminator = "?>";
+            }
+            else if (stream.Available() >= 4 && std::memcmp(stream.Data(), "<!--", 4) == 0) {
+                terminator = "-->";
+            }
+            else if (stream.Available() >= 9 && std::memcmp(stream.Data(), "<![CDATA[", 9) == 0) {
+                terminator = "]]>";
+            }
+            size_t end = stream.FindEnd(terminator, 2);
+            if (end == SIZE_MAX) {
+                return false;
+            }
+            if (capture != CAPTURE_NONE && terminator[0] == ']') {
+                text.append(stream.Data() + 9, end - 12);
+            }
+            stream.Advance(end);
+            continue;
+        }
+
+        size_t tagEnd = stream.FindTagEnd();
+        if (tagEnd == SIZE_MAX) {
+            return false;
+        }
+        const char* tag = stream.Data() + 1;
+        size_t tagLength = tagEnd - 1;
+
+        if (kind == '/') {
+            const char* name = tag + 1;
+            size_t nameLength = tagLength - 1;
+            while (nameLength > 0 && isSpace(name[nameLength - 1])) {
+                --nameLength;
+            }
+            if (capture != CAPTURE_NONE) {
+                storeCapture(capture, captureChannel, text, track);
+                capture = CAPTURE_NONE;
+            }
+            else if (inPoint && localNameEquals(name, nameLength, "trkpt")) {
+                inPoint = false;
+            }
+        }
+        else {
+            bool selfClosing = tagLength > 0 && tag[tagLength - 1] == '/';
+            size_t nameLength = 0;
+            while (nameLength < tagLength && !isSpace(tag[nameLength]) && tag[nameLength] != '/') {
+                ++nameLength;
+            }
+
+            if (localNameEquals(tag, nameLength, "trkpt")) {
+                double latitude = 0.0, longitude = 0.0;
+                findAttribute(tag, tagLength, "lat", latitude);
+                findAttribute(tag, tagLength, "lon", longitude);
+                track.AddPoint(latitude, longitude);
+                inPoint = !selfClosing;
+            }
+            else if (inPoint && !selfClosing && capture == CAPTURE_NONE) {
+                if (localNameEquals(tag, nameLength, "time")) {
+                    capture = CAPTURE_TIME;
+                }
+                for (const GpxChannelElement& element : GPX_CHANNEL_ELEMENTS) {
+                    if (localNameEquals(tag, nameLength, element.name)) {
+                        capture = CAPTURE_CHANNEL;
+                        captureChannel = element.channel;
+                    }
+                }
+                text.clear();
+            }
+        }
+        stream.Advance(tagEnd + 1);
+    }
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+int64_t daysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+bool parseDigits(const char* text, size_t count, int& value) {
+    value = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+} // namespace
+
+bool ParseGpxTime(const char* text, size_t length, int64_t& millisecondsUtc) {
+    while (length > 0 && isSpace(*text)) {
+        ++text;
+        --length;
+    }
+    while (length > 0 && isSpace(text[length - 1])) {
+        --length;
+    }
+
+    // YYYY-MM-DDTHH:MM:SS is fixed width
+    int year, month, day, hour, minute, second;
+    if (length < 19 || text[4] != '-' || text[7] != '-' || (text[10] != 'T' && text[10] != ' ') || text[13] != ':' || text[16] != ':'
+        || !parseDigits(text, 4, year) || !parseDigits(text + 5, 2, month) || !parseDigits(text + 8, 2, day)
+        || !parseDigits(text + 11, 2, hour) || !parseDigits(text + 14, 2, minute) || !parseDigits(text + 17, 2, second)
+        || month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+
+    // Optional fraction, kept to the millisecond
+    size_t position = 19;
+    int64_t milliseconds = 0;
+    if (position < length && text[position] == '.') {
+        int64_t scale = 100;
+        for (++position; position < length && text[position] >= '0' && text[position] <= '9'; ++position) {
+            milliseconds += (text[position] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    // Optional zone designator; no designator is taken as UTC
+    int64_t offsetMinutes = 0;
+    bool utc = position == length || (text[position] == 'Z' && position + 1 == length);
+    if (!utc) {
+        char sign = text[position];
+        int offsetHours, offsetMins;
+        if ((sign != '+' && sign != '-') || position + 6 != length || text[position + 3] != ':'
+            || !parseDigits(text + position + 1, 2, offsetHours) || !parseDigits(text + position + 4, 2, offsetMins)) {
+            return false;
+        }
+        offsetMinutes = (offsetHours * 60 + offsetMins) * (sign == '-' ? -1 : 1);
+    }
+
+    int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offsetMinutes * 60;
+    millisecondsUtc = seconds * 1000 + milliseconds;
+    return true;
+}
+
+bool ReadGpxStreaming(const std::string& path, Track& track) {
+    track.Clear();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Failed to load GPX file: " << path << "\n";
+        return false;
+    }
+    bool success = readGpxStream(file, track);
+    std::fclose(file);
+    if (!success) {
+        std::cerr << "Malformed GPX file: " << path << "\n";
+        track.Clear();
+    }
+    return success;
+}
+
+bool ReadGpxDocument(const std::string& path, Track& track) {
+    track.Clear();
+    pugi::xml_document doc;
+    pugi::xml_parse_result result = doc.load_file(path.c_str());
+
+    if (!result) {
+        std::cerr << "Failed to load GPX file: " << path << "\n";
+        return false;
+    }
+
+    // Use XPath to select all 'trkpt' elements, regardless of namespace
+    pugi::xpath_node_set trkpts = doc.select_nodes("//*[local-name()='trkpt']");
+    track.Reserve(trkpts.size());
+
+    // Values may sit directly in the point or nested in its extensions
+    pugi::xpath_query timeQuery(".//*[local-name()='time']");
+    std::vector<pugi::xpath_query> channelQueries;
+    for (const GpxChannelElement& element : GPX_CHANNEL_ELEMENTS) {
+        channelQueries.emplace_back((std::string(".//*[local-name()='") + element.name + "']").c_str());
+    }
+
+    for (pugi::xpath_node xpath_node : trkpts) {
+        pugi::xml_node trkpt = xpath_node.node();
+        size_t point = track.AddPoint(trkpt.attribute("lat").as_double(), trkpt.attribute("lon").as_double());
+
+        pugi::xpath_node time_node = trkpt.select_node(timeQuery);
+        int64_t time;
+        const char* text = time_node ? time_node.node().text().get() : "";
+        if (ParseGpxTime(text, std::strlen(text), time)) {
+            track.SetTime(point, time);
+        }
+
+        for (size_t i = 0; i < channelQueries.size(); ++i) {
+            pugi::xpath_node value_node = trkpt.select_node(channelQueries[i]);
+            if (value_node) {
+                track.SetValue(GPX_CHANNEL_ELEMENTS[i].channel, point, static_cast<float>(value_node.node().text().as_double()));
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ReadGpx(const std::string& path, Track& track) {
+    if (ReadGpxStreaming(path, track)) {
+        return true;
+    }
+    std::cerr << "Falling back to the DOM GPX reader for: " << path << "\n";
+    return ReadGpxDocument(path, track);
+}
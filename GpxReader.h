@@ -0,0 +1,24 @@
+#ifndef GPX_READER_H
+#define GPX_READER_H
+
+#include <cstdint>
+#include <string>
+#include "Track.h"
+
+// Reads every <trkpt> into the track: position, <ele>, <time> and the Garmin TrackPointExtension
+// <hr>, <cad> and <atemp> values written by Strava and most watches.
+
+// Single pass over the file in fixed-size chunks without building a DOM. Element names are matched
+// without their namespace prefix. Returns false if the file cannot be read or is not well formed.
+bool ReadGpxStreaming(const std::string& path, Track& track);
+
+// Reference reader: pugixml DOM with XPath queries; slower and holds the whole document in memory
+bool ReadGpxDocument(const std::string& path, Track& track);
+
+// Streaming reader, falling back to the pugixml reader when the stream cannot be parsed
+bool ReadGpx(const std::string& path, Track& track);
+
+// Parses an ISO 8601 / xsd:dateTime timestamp such as 2024-06-18T13:58:44Z or 2024-06-18T15:58:44.5+02:00
+bool ParseGpxTime(const char* text, size_t length, int64_t& millisecondsUtc);
+
+#endif
@@ -0,0 +1,401 @@
+#include "Headless.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "Scene.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+#include "Profiler.h"
+#include "InputRecording.h"
+#include "Simulation.h"
+
+namespace {
+
+// Context without a window. EGL is tried first on Linux and a hidden GLFW window is the fallback.
+class HeadlessContext {
+public:
+    HeadlessContext() : window(nullptr) {
+#ifdef __linux__
+        display = EGL_NO_DISPLAY;
+        context = EGL_NO_CONTEXT;
+#endif
+    }
+    ~HeadlessContext() {
+#ifdef __linux__
+        if (context != EGL_NO_CONTEXT) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        if (display != EGL_NO_DISPLAY) {
+            eglTerminate(display);
+        }
+#endif
+        if (window) {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
+    }
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Creates a 3.3 core context, makes it current and returns its loader, or nullptr
+    GLADloadproc Create() {
+#ifdef __linux__
+        if (createEGL()) {
+            return reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+        }
+#endif
+        if (!glfwInit()) {
+            return nullptr;
+        }
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(64, 64, "3D Hiking Simulator (headless)", NULL, NULL);
+        if (!window) {
+            glfwTerminate();
+            return nullptr;
+        }
+        glfwMakeContextCurrent(window);
+        return reinterpret_cast<GLADloadproc>(glfwGetProcAddress);
+    }
+
+private:
+    GLFWwindow* window;
+#ifdef __linux__
+    EGLDisplay display;
+    EGLContext context;
+
+    // Surfaceless: all rendering goes to framebuffer objects
+    bool createEGL() {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+            display = EGL_NO_DISPLAY;
+            return false;
+        }
+
+        const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLConfig config = EGL_NO_CONFIG_KHR;
+        EGLint configCount = 0;
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+            config = EGL_NO_CONFIG_KHR;
+        }
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            return false;
+        }
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT) {
+            return false;
+        }
+        return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+    }
+#endif
+};
+
+// Color and depth renderbuffers the scene is drawn into
+class OffscreenTarget {
+public:
+    OffscreenTarget() : framebuffer(0), color(0), depth(0) {}
+    ~OffscreenTarget() {
+        if (framebuffer != 0) {
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(1, &color);
+            glDeleteRenderbuffers(1, &depth);
+        }
+    }
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    bool Create(int width, int height) {
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glGenRenderbuffers(1, &color);
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        glGenRenderbuffers(1, &depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        glViewport(0, 0, width, height);
+        return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+
+private:
+    GLuint framebuffer, color, depth;
+};
+
+// Positions at a distance along a polyline
+class PathFlight {
+public:
+    explicit PathFlight(const std::vector<glm::vec3>& points) : points(points), distances(points.size(), 0.0f) {
+        for (size_t i = 1; i < points.size(); ++i) {
+            distances[i] = distances[i - 1] + glm::length(points[i] - points[i - 1]);
+        }
+    }
+
+    float GetLength() const { return distances.empty() ? 0.0f : distances.back(); }
+
+    // Clamped to the ends of the path
+    glm::vec3 At(float distance) const {
+        if (points.empty()) {
+            return glm::vec3(0.0f);
+        }
+        if (distance <= 0.0f) {
+            return points.front();
+        }
+        if (distance >= GetLength()) {
+            return points.back();
+        }
+        size_t next = std::upper_bound(distances.begin(), distances.end(), distance) - distances.begin();
+        float span = distances[next] - distances[next - 1];
+        float t = span > 0.0f ? (distance - distances[next - 1]) / span : 0.0f;
+        return glm::mix(points[next - 1], points[next], t);
+    }
+
+private:
+    const std::vector<glm::vec3>& points;
+    std::vector<float> distances;
+};
+
+std::string escapeJSON(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void writeSummary(std::ostream& out, const char* name, const FrameTimeSummary& summary) {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+        "  \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+        name, summary.mean, summary.p50, summary.p95, summary.p99, summary.max);
+    out << line;
+}
+
+} // namespace
+
+FrameTimeSummary SummarizeFrameTimes(std::vector<double> milliseconds) {
+    FrameTimeSummary summary = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+    if (milliseconds.empty()) {
+        return summary;
+    }
+    std::sort(milliseconds.begin(), milliseconds.end());
+    double total = 0.0;
+    for (double value : milliseconds) {
+        total += value;
+    }
+    size_t count = milliseconds.size();
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * count));
+        return milliseconds[std::min(std::max(rank, size_t(1)), count) - 1];
+    };
+    summary.mean = total / count;
+    summary.p50 = percentile(50.0);
+    summary.p95 = percentile(95.0);
+    summary.p99 = percentile(99.0);
+    summary.max = milliseconds.back();
+    return summary;
+}
+
+int RunHeadless(const HeadlessOptions& options) {
+    bool replaying = !options.replayPath.empty();
+    InputReplay replay;
+    if (replaying && !replay.Load(options.replayPath)) {
+        return -1;
+    }
+    int measuredFrames = replaying ? static_cast<int>(replay.GetFrameCount()) : options.frames;
+    if (measuredFrames < 1 || options.width < 1 || options.height < 1) {
+        std::cerr << "ERROR::HEADLESS::INVALID_OPTIONS: need at least one frame and a non-empty framebuffer\n";
+        return -1;
+    }
+    HeadlessContext headlessContext;
+    GLADloadproc load = headlessContext.Create();
+    if (!load) {
+        std::cerr << "ERROR::HEADLESS::NO_CONTEXT: neither EGL nor GLFW could create an OpenGL 3.3 context\n";
+        return -1;
+    }
+    if (!gladLoadGLLoader(load)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        return -1;
+    }
+    InitProgramCache(load);
+
+    OffscreenTarget target;
+    if (!target.Create(options.width, options.height)) {
+        std::cerr << "ERROR::HEADLESS::FRAMEBUFFER_INCOMPLETE: " << options.width << "x" << options.height << '\n';
+        return -1;
+    }
+
+    Scene scene;
+    scene.Load();
+    const std::vector<glm::vec3>& points = scene.GetPath().GetPoints();
+    if (points.size() < 2) {
+        std::cerr << "ERROR::HEADLESS::NO_PATH: the flight follows the GPX path\n";
+        return -1;
+    }
+    PathFlight flight(points);
+    Camera camera(points.front() + glm::vec3(0.0f, HEADLESS_CAMERA_HEIGHT, 0.0f));
+    if (replaying) {
+        replay.ApplyStart(camera);
+    }
+    // A replay walks through the simulation; the flight only extends the trail, which starts at the camera
+    std::unique_ptr<Simulation> simulation;
+    PathTrail& trail = scene.GetPathTracer().GetTrail();
+    glm::vec3 lastTrailPosition = camera.Position;
+    if (replaying) {
+        simulation.reset(new Simulation(scene));
+        simulation->Reset(camera);
+    }
+    else {
+        trail.AddPoint(camera.Position);
+    }
+
+    // Every pass is timed on the GPU; a frame's GPU time is the sum of its passes
+    int totalFrames = HEADLESS_WARMUP_FRAMES + measuredFrames;
+    Profiler& profiler = scene.GetProfiler();
+    profiler.SetHistory(static_cast<size_t>(totalFrames));
+    profiler.SetEnabled(true);
+
+    std::vector<double> cpuMs, frameMs;
+    double triangles = 0.0, uniformCalls = 0.0, stateCalls = 0.0;
+    for (int frame = 0; frame < totalFrames; ++frame) {
+        // Warm-up frames stay at the start; the measured frames cover the whole path or recording
+        if (replaying) {
+            InputFrame input;
+            if (frame >= HEADLESS_WARMUP_FRAMES && replay.Next(input)) {
+                simulation->Advance(input, camera);
+            }
+        }
+        else {
+            int measured = std::max(frame - HEADLESS_WARMUP_FRAMES, 0);
+            float distance = measuredFrames > 1 ? flight.GetLength() * measured / (measuredFrames - 1) : 0.0f;
+            camera.Position = flight.At(distance) + glm::vec3(0.0f, HEADLESS_CAMERA_HEIGHT, 0.0f);
+            camera.LookAt(flight.At(distance + HEADLESS_LOOK_AHEAD));
+
+            SampleTrail(trail, lastTrailPosition, camera.Position);
+        }
+
+        Shader::ResetUniformCallCount();
+        ResetGLStateStats();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        scene.Render(camera, options.width, options.height);
+        double submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Waiting for the frame keeps frames from overlapping, so each time is one frame's own. Software
+        // rasterisers such as llvmpipe do most of their work here, outside the timer queries.
+        glFinish();
+        double finishedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (frame >= HEADLESS_WARMUP_FRAMES) {
+            cpuMs.push_back(submitMs);
+            frameMs.push_back(finishedMs);
+            triangles += scene.GetTerrain().GetCullStats().drawnTriangles;
+            uniformCalls += Shader::GetUniformCallCount();
+            stateCalls += GetGLStateStats().issued;
+        }
+    }
+    profiler.Flush();
+    profiler.WriteChromeTrace(PROFILER_DEFAULT_TRACE);
+
+    // Per-frame GPU totals and per-pass means over the measured frames
+    const std::vector<std::string>& passNames = profiler.GetPassNames();
+    std::vector<double> gpuMs, passCpuMs(passNames.size(), 0.0), passGpuMs(passNames.size(), 0.0);
+    for (const ProfilerFrame& profiled : profiler.GetFrames()) {
+        if (profiled.index < static_cast<uint64_t>(HEADLESS_WARMUP_FRAMES)) {
+            continue;
+        }
+        double frameGpuMs = 0.0;
+        for (const ProfilerEvent& event : profiled.events) {
+            passCpuMs[event.pass] += event.cpuMs;
+            if (event.gpuMs >= 0.0) {
+                passGpuMs[event.pass] += event.gpuMs;
+                frameGpuMs += event.gpuMs;
+            }
+        }
+        gpuMs.push_back(frameGpuMs);
+    }
+
+    FrameTimeSummary cpu = SummarizeFrameTimes(cpuMs);
+    FrameTimeSummary gpu = SummarizeFrameTimes(gpuMs);
+    FrameTimeSummary total = SummarizeFrameTimes(frameMs);
+    double frames = static_cast<double>(measuredFrames);
+    std::ofstream report(options.reportPath);
+    if (!report) {
+        std::cerr << "ERROR::HEADLESS::FAILED_TO_WRITE: " << options.reportPath << '\n';
+        return -1;
+    }
+    char line[256];
+    report << "{\n";
+    report << "  \"renderer\": \"" << escapeJSON(reinterpret_cast<const char*>(glGetString(GL_RENDERER))) << "\",\n";
+    report << "  \"version\": \"" << escapeJSON(reinterpret_cast<const char*>(glGetString(GL_VERSION))) << "\",\n";
+    std::snprintf(line, sizeof(line), "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n  \"warmup_frames\": %d,\n",
+        options.width, options.height, measuredFrames, HEADLESS_WARMUP_FRAMES);
+    report << line;
+    if (replaying) {
+        report << "  \"replay\": \"" << escapeJSON(options.replayPath) << "\",\n";
+    }
+    std::snprintf(line, sizeof(line), "  \"path_length\": %.1f,\n  \"terrain_lod\": %s,\n", flight.GetLength(),
+        scene.GetTerrain().IsLODEnabled() ? "true" : "false");
+    report << line;
+    writeSummary(report, "frame_ms", total);
+    report << ",\n";
+    writeSummary(report, "cpu_ms", cpu);
+    report << ",\n";
+    writeSummary(report, "gpu_ms", gpu);
+    report << ",\n  \"passes\": {";
+    for (size_t pass = 0; pass < passNames.size(); ++pass) {
+        std::snprintf(line, sizeof(line), "%s\n    \"%s\": { \"cpu_ms\": %.4f, \"gpu_ms\": %.4f }", pass > 0 ? "," : "",
+            passNames[pass].c_str(), passCpuMs[pass] / frames, passGpuMs[pass] / frames);
+        report << line;
+    }
+    report << "\n  },\n";
+    std::snprintf(line, sizeof(line),
+        "  \"per_frame\": { \"terrain_triangles\": %.0f, \"uniform_calls\": %.1f, \"gl_state_calls\": %.1f }\n",
+        triangles / frames, uniformCalls / frames, stateCalls / frames);
+    report << line << "}\n";
+
+    std::printf("headless: %d frames at %dx%d on %s\n", measuredFrames, options.width, options.height,
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    std::printf("  frame ms: p50 %.3f, p95 %.3f, p99 %.3f\n", total.p50, total.p95, total.p99);
+    std::printf("  cpu ms: p50 %.3f, p95 %.3f, p99 %.3f\n", cpu.p50, cpu.p95, cpu.p99);
+    std::printf("  gpu ms: p50 %.3f, p95 %.3f, p99 %.3f\n", gpu.p50, gpu.p95, gpu.p99);
+    std::printf("  report: %s\n", options.reportPath.c_str());
+    std::printf("  trace: %s\n", PROFILER_DEFAULT_TRACE);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <string>
+#include <vector>
+
+const int HEADLESS_DEFAULT_FRAMES = 600;
+const int HEADLESS_DEFAULT_WIDTH = 1280;
+const int HEADLESS_DEFAULT_HEIGHT = 720;
+const char* const HEADLESS_DEFAULT_REPORT = "frame_times.json";
+// Frames drawn at the start of the flight before timing begins, so first-use driver work is not counted
+const int HEADLESS_WARMUP_FRAMES = 30;
+// Camera height above the path and distance along it to the point the camera looks at
+const float HEADLESS_CAMERA_HEIGHT = 2.0f;
+const float HEADLESS_LOOK_AHEAD = 30.0f;
+
+struct HeadlessOptions {
+    int frames;
+    int width;
+    int height;
+    std::string reportPath;
+    std::string replayPath;  // Input recording that drives the camera instead of the path flight; frames is then its length
+};
+
+// Frame times in milliseconds; percentiles use the nearest rank
+struct FrameTimeSummary {
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+};
+
+FrameTimeSummary SummarizeFrameTimes(std::vector<double> milliseconds);
+
+// Renders a camera flight along the GPX path into an offscreen framebuffer, without a window, and
+// writes frame-time percentiles to a JSON report: frame_ms from the start of a frame until glFinish
+// returns, cpu_ms for issuing its GL calls and gpu_ms as the sum of the profiler's per-pass timer queries.
+// The report also lists the mean time of each pass, and the profiler's Chrome trace is written next to it.
+// On Linux the context comes from EGL, so Mesa's llvmpipe works on machines with no display or GPU;
+// elsewhere a hidden GLFW window is used. With a replay the recorded input drives the same fixed-step
+// Simulation as the window, advanced by the recorded frame times, so builds can be compared on the same walk.
+// Returns a process exit code.
+int RunHeadless(const HeadlessOptions& options);
+
+#endif
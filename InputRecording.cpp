@@ -0,0 +1,141 @@
+#include "InputRecording.h"
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+const char INPUT_RECORDING_MAGIC[4] = { 'H', 'K', 'I', 'N' };
+// Version 2: frames drive the fixed-step Simulation, which moves the camera differently from the
+// per-frame movement that version 1 recordings were made with
+const uint32_t INPUT_RECORDING_VERSION = 2;
+// Magic, version, start position, yaw and pitch
+const size_t INPUT_HEADER_SIZE = 4 + 4 + 5 * 4;
+// deltaTime, mouseX, mouseY and keys, without padding
+const size_t INPUT_FRAME_SIZE = 3 * 4 + 1;
+
+template <typename T>
+char* put(char* out, const T& value) {
+    std::memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+}
+
+template <typename T>
+const char* get(const char* in, T& value) {
+    std::memcpy(&value, in, sizeof(T));
+    return in + sizeof(T);
+}
+
+} // namespace
+
+InputRecorder::InputRecorder() : frameCount(0) {
+}
+
+InputRecorder::~InputRecorder() {
+    Stop();
+}
+
+bool InputRecorder::Start(const std::string& recordingPath, const Camera& camera) {
+    Stop();
+    out.open(recordingPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "ERROR::INPUT_RECORDING::FAILED_TO_CREATE: " << recordingPath << std::endl;
+        return false;
+    }
+    path = recordingPath;
+    frameCount = 0;
+
+    char header[INPUT_HEADER_SIZE];
+    char* cursor = header;
+    std::memcpy(cursor, INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC));
+    cursor += sizeof(INPUT_RECORDING_MAGIC);
+    cursor = put(cursor, INPUT_RECORDING_VERSION);
+    cursor = put(cursor, camera.Position.x);
+    cursor = put(cursor, camera.Position.y);
+    cursor = put(cursor, camera.Position.z);
+    cursor = put(cursor, camera.Yaw);
+    put(cursor, camera.Pitch);
+    out.write(header, sizeof(header));
+    return true;
+}
+
+void InputRecorder::Record(const InputFrame& frame) {
+    if (!out.is_open()) {
+        return;
+    }
+    char record[INPUT_FRAME_SIZE];
+    char* cursor = put(record, frame.deltaTime);
+    cursor = put(cursor, frame.mouseX);
+    cursor = put(cursor, frame.mouseY);
+    put(cursor, frame.keys);
+    out.write(record, sizeof(record));
+    ++frameCount;
+}
+
+void InputRecorder::Stop() {
+    if (!out.is_open()) {
+        return;
+    }
+    out.close();
+    if (out.fail()) {
+        std::cerr << "ERROR::INPUT_RECORDING::FAILED_TO_WRITE: " << path << std::endl;
+    }
+    else {
+        std::cout << "Recorded " << frameCount << " frames of input to " << path << '\n';
+    }
+}
+
+InputReplay::InputReplay() : startPosition(0.0f), startYaw(YAW), startPitch(PITCH), position(0) {
+}
+
+bool InputReplay::Load(const std::string& path) {
+    frames.clear();
+    position = 0;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "ERROR::INPUT_REPLAY::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < INPUT_HEADER_SIZE
+        || std::memcmp(data.data(), INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC)) != 0) {
+        std::cerr << "ERROR::INPUT_REPLAY::NOT_A_RECORDING: " << path << std::endl;
+        return false;
+    }
+    uint32_t version = 0;
+    const char* cursor = get(data.data() + sizeof(INPUT_RECORDING_MAGIC), version);
+    if (version != INPUT_RECORDING_VERSION) {
+        std::cerr << "ERROR::INPUT_REPLAY::UNSUPPORTED_VERSION: " << version << " in " << path << std::endl;
+        return false;
+    }
+    cursor = get(cursor, startPosition.x);
+    cursor = get(cursor, startPosition.y);
+    cursor = get(cursor, startPosition.z);
+    cursor = get(cursor, startYaw);
+    cursor = get(cursor, startPitch);
+
+    // A recording cut short by a crash ends in a partial frame, which is dropped
+    size_t count = (data.size() - INPUT_HEADER_SIZE) / INPUT_FRAME_SIZE;
+    frames.resize(count);
+    for (InputFrame& frame : frames) {
+        cursor = get(cursor, frame.deltaTime);
+        cursor = get(cursor, frame.mouseX);
+        cursor = get(cursor, frame.mouseY);
+        cursor = get(cursor, frame.keys);
+    }
+    return true;
+}
+
+void InputReplay::ApplyStart(Camera& camera) const {
+    camera.Position = startPosition;
+    camera.SetOrientation(startYaw, startPitch);
+}
+
+bool InputReplay::Next(InputFrame& frame) {
+    if (position >= frames.size()) {
+        return false;
+    }
+    frame = frames[position++];
+    return true;
+}
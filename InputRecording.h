@@ -0,0 +1,75 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Camera.h"
+
+const char* const INPUT_RECORDING_DEFAULT = "input_recording.bin";
+
+// Bits of InputFrame::keys
+const uint8_t INPUT_KEY_FORWARD = 1 << 0;
+const uint8_t INPUT_KEY_BACKWARD = 1 << 1;
+const uint8_t INPUT_KEY_LEFT = 1 << 2;
+const uint8_t INPUT_KEY_RIGHT = 1 << 3;
+const uint8_t INPUT_KEY_TOGGLE_LOD = 1 << 4;  // Set only on the frame the key went down
+
+// The input of one frame: everything that changes what the next frame draws
+struct InputFrame {
+    float deltaTime;
+    float mouseX;     // Mouse offsets since the previous frame, y pointing up
+    float mouseY;
+    uint8_t keys;
+};
+
+// Writes one InputFrame per frame to a binary file: a header with the camera pose at the start, then
+// 13 bytes per frame in the byte order of the machine that recorded it (little-endian everywhere we ship)
+class InputRecorder {
+public:
+    InputRecorder();
+    ~InputRecorder();
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    // Truncates the file and writes the header; returns false when it cannot be created
+    bool Start(const std::string& path, const Camera& camera);
+    void Record(const InputFrame& frame);
+    // Flushes and closes the file; also done by the destructor
+    void Stop();
+
+    bool IsRecording() const { return out.is_open(); }
+    size_t GetFrameCount() const { return frameCount; }
+
+private:
+    std::ofstream out;
+    std::string path;
+    size_t frameCount;
+};
+
+// A recording loaded into memory and played back frame by frame. Feeding the recorded deltaTime to the
+// Simulation moves the camera the same way however fast the replay renders.
+class InputReplay {
+public:
+    InputReplay();
+
+    bool Load(const std::string& path);
+    // Puts the camera where it was when recording started
+    void ApplyStart(Camera& camera) const;
+    // Returns false once every frame has been played
+    bool Next(InputFrame& frame);
+    void Rewind() { position = 0; }
+
+    size_t GetFrameCount() const { return frames.size(); }
+    bool IsFinished() const { return position >= frames.size(); }
+
+private:
+    glm::vec3 startPosition;
+    float startYaw, startPitch;
+    std::vector<InputFrame> frames;
+    size_t position;
+};
+
+#endif
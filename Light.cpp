@@ -1,31 +1,40 @@
 #include "Light.h"
 
-void DirectionalLight::ApplyToShader(Shader& shader, const std::string& name) {
-    shader.setVec3(name + ".direction", direction);
-    shader.setVec3(name + ".ambient", ambient);
-    shader.setVec3(name + ".diffuse", diffuse);
-    shader.setVec3(name + ".specular", specular);
+// The directional light has a single slot; adding another replaces it
+bool DirectionalLight::PackInto(LightingBlock& block) const {
+    DirectionalLightBlock& slot = block.directional;
+    slot.direction = glm::vec4(direction, 0.0f);
+    slot.ambient = glm::vec4(ambient, 0.0f);
+    slot.diffuse = glm::vec4(diffuse, 0.0f);
+    slot.specular = glm::vec4(specular, 0.0f);
+    block.counts.x = 1;
+    return true;
 }
 
-void PointLight::ApplyToShader(Shader& shader, const std::string& name) {
-    shader.setVec3(name + ".position", position);
-    shader.setVec3(name + ".ambient", ambient);
-    shader.setVec3(name + ".diffuse", diffuse);
-    shader.setVec3(name + ".specular", specular);
-    shader.setFloat(name + ".constant", constant);
-    shader.setFloat(name + ".linear", linear);
-    shader.setFloat(name + ".quadratic", quadratic);
+bool PointLight::PackInto(LightingBlock& block) const {
+    if (block.counts.y >= MAX_POINT_LIGHTS) {
+        return false;
+    }
+    PointLightBlock& slot = block.pointLights[block.counts.y++];
+    slot.position = glm::vec4(position, 1.0f);
+    slot.ambient = glm::vec4(ambient, 0.0f);
+    slot.diffuse = glm::vec4(diffuse, 0.0f);
+    slot.specular = glm::vec4(specular, 0.0f);
+    slot.attenuation = glm::vec4(constant, linear, quadratic, 0.0f);
+    return true;
 }
 
-void SpotLight::ApplyToShader(Shader& shader, const std::string& name) {
-    shader.setVec3(name + ".position", position);
-    shader.setVec3(name + ".direction", direction);
-    shader.setVec3(name + ".ambient", ambient);
-    shader.setVec3(name + ".diffuse", diffuse);
-    shader.setVec3(name + ".specular", specular);
-    shader.setFloat(name + ".cutOff", cutOff);
-    shader.setFloat(name + ".outerCutOff", outerCutOff);
-    shader.setFloat(name + ".constant", constant);
-    shader.setFloat(name + ".linear", linear);
-    shader.setFloat(name + ".quadratic", quadratic);
+bool SpotLight::PackInto(LightingBlock& block) const {
+    if (block.counts.z >= MAX_SPOT_LIGHTS) {
+        return false;
+    }
+    SpotLightBlock& slot = block.spotLights[block.counts.z++];
+    slot.position = glm::vec4(position, 1.0f);
+    slot.direction = glm::vec4(direction, 0.0f);
+    slot.ambient = glm::vec4(ambient, 0.0f);
+    slot.diffuse = glm::vec4(diffuse, 0.0f);
+    slot.specular = glm::vec4(specular, 0.0f);
+    slot.attenuation = glm::vec4(constant, linear, quadratic, 0.0f);
+    slot.cone = glm::vec4(cutOff, outerCutOff, 0.0f, 0.0f);
+    return true;
 }
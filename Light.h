@@ -2,8 +2,7 @@
 #define LIGHT_H
 
 #include <glm/glm.hpp>
-#include <string>
-#include "Shader.h"
+#include "UniformBlocks.h"
 
 class Light {
 public:
@@ -17,7 +16,9 @@ public:
         : ambient(ambient), diffuse(diffuse), specular(specular) {
     }
 
-    virtual void ApplyToShader(Shader& shader, const std::string& name) = 0;
+    // Writes the light into its slot of the Lighting block, the only way lights reach the shaders;
+    // false if the block has no room for it
+    virtual bool PackInto(LightingBlock& block) const = 0;
 };
 
 class DirectionalLight : public Light {
@@ -31,7 +32,7 @@ public:
         : Light(ambient, diffuse, specular), direction(direction) {
     }
 
-    void ApplyToShader(Shader& shader, const std::string& name) override;
+    bool PackInto(LightingBlock& block) const override;
 };
 
 class PointLight : public Light {
@@ -53,7 +54,7 @@ public:
         constant(constant), linear(linear), quadratic(quadratic) {
     }
 
-    void ApplyToShader(Shader& shader, const std::string& name) override;
+    bool PackInto(LightingBlock& block) const override;
 };
 
 class SpotLight : public Light {
@@ -83,7 +84,7 @@ public:
         constant(constant), linear(linear), quadratic(quadratic) {
     }
 
-    void ApplyToShader(Shader& shader, const std::string& name) override;
+    bool PackInto(LightingBlock& block) const override;
 };
 
 #endif 
\ No newline at end of file
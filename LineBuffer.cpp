@@ -0,0 +1,157 @@
+#include "LineBuffer.h"
+#include "GLState.h"
+#include <algorithm>
+#include <iostream>
+
+glm::u8vec4 PackLineColor(const glm::vec4& color) {
+    glm::vec4 scaled = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+    return glm::u8vec4(scaled);
+}
+
+LineBuffer::LineBuffer() : VAO(0), vertexBuffer(0), colorBuffer(0), indexBuffer(0),
+    vertexTexture(0), colorTexture(0), indexTexture(0), capacity(0), indexCapacity(0), indexCount(0), uniforms() {
+}
+
+LineBuffer::~LineBuffer() {
+    if (VAO != 0) {
+        GLuint textures[3] = { vertexTexture, colorTexture, indexTexture };
+        DeleteTextures(3, textures);
+        GLuint buffers[3] = { vertexBuffer, colorBuffer, indexBuffer };
+        glDeleteBuffers(3, buffers);
+        DeleteVertexArrays(1, &VAO);
+    }
+}
+
+void LineBuffer::create() {
+    // Quads are generated from gl_VertexID; the core profile still needs a vertex array bound
+    glGenVertexArrays(1, &VAO);
+
+    GLuint buffers[3];
+    glGenBuffers(3, buffers);
+    vertexBuffer = buffers[0];
+    colorBuffer = buffers[1];
+    indexBuffer = buffers[2];
+
+    GLuint textures[3];
+    glGenTextures(3, textures);
+    vertexTexture = textures[0];
+    colorTexture = textures[1];
+    indexTexture = textures[2];
+
+    // A buffer texture refers to the buffer object, so later reallocations need no rebinding
+    const GLuint attached[3] = { vertexBuffer, colorBuffer, indexBuffer };
+    const GLuint views[3] = { vertexTexture, colorTexture, indexTexture };
+    const GLenum formats[3] = { GL_RGBA32F, GL_RGBA8, GL_R32UI };
+    for (int i = 0; i < 3; ++i) {
+        glBindBuffer(GL_TEXTURE_BUFFER, attached[i]);
+        glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_DYNAMIC_DRAW);
+        BindTexture(0, GL_TEXTURE_BUFFER, views[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], attached[i]);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+bool LineBuffer::Reserve(size_t vertexCount) {
+    if (vertexCount <= capacity) {
+        return true;
+    }
+    if (VAO == 0) {
+        create();
+    }
+
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    size_t limit = maxTexels > 0 ? static_cast<size_t>(maxTexels) : vertexCount;
+    if (vertexCount > limit) {
+        // Already at the limit and reported
+        if (capacity == limit) {
+            return false;
+        }
+        std::cerr << "ERROR::LINE_BUFFER::TOO_LARGE: " << vertexCount << " vertices, buffer textures hold " << maxTexels << std::endl;
+    }
+
+    capacity = std::min(vertexCount, limit);
+    glBindBuffer(GL_TEXTURE_BUFFER, vertexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, colorBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, capacity * sizeof(glm::u8vec4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    return capacity == vertexCount;
+}
+
+void LineBuffer::Update(size_t first, const glm::vec4* positionWidths, const glm::u8vec4* colors, size_t count) {
+    if (first >= capacity) {
+        return;
+    }
+    count = std::min(count, capacity - first);
+    if (count == 0) {
+        return;
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, vertexBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(glm::vec4), count * sizeof(glm::vec4), positionWidths);
+    glBindBuffer(GL_TEXTURE_BUFFER, colorBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(glm::u8vec4), count * sizeof(glm::u8vec4), colors);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void LineBuffer::SetIndices(const std::vector<unsigned int>& indices) {
+    indexCount = indices.size();
+    if (indices.empty() || VAO == 0) {
+        return;
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+    if (indices.size() > indexCapacity) {
+        indexCapacity = std::max(indices.size(), indexCapacity * 2);
+        glBufferData(GL_TEXTURE_BUFFER, indexCapacity * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void LineBuffer::bind(Shader& shader, bool indexed) {
+    shader.Use();
+    if (uniforms.program != shader.ID) {
+        uniforms.program = shader.ID;
+        uniforms.vertices = shader.GetUniform<int>("vertices");
+        uniforms.colors = shader.GetUniform<int>("colors");
+        uniforms.indices = shader.GetUniform<int>("indices");
+        uniforms.firstVertex = shader.GetUniform<int>("firstVertex");
+        uniforms.ringSize = shader.GetUniform<int>("ringSize");
+        uniforms.indexed = shader.GetUniform<bool>("indexed");
+    }
+
+    // Depth-tested against the terrain; the quads' winding depends on the line direction, so no culling
+    SetCapability(GL_DEPTH_TEST, true);
+    SetDepthFunc(GL_LESS);
+    SetDepthMask(true);
+    SetCapability(GL_CULL_FACE, false);
+
+    BindTexture(0, GL_TEXTURE_BUFFER, vertexTexture);
+    shader.set(uniforms.vertices, 0);
+    BindTexture(1, GL_TEXTURE_BUFFER, colorTexture);
+    shader.set(uniforms.colors, 1);
+    BindTexture(2, GL_TEXTURE_BUFFER, indexTexture);
+    shader.set(uniforms.indices, 2);
+    shader.set(uniforms.indexed, indexed);
+
+    BindVertexArray(VAO);
+}
+
+void LineBuffer::Draw(Shader& shader, size_t first, size_t segmentCount, size_t ringSize) {
+    if (VAO == 0 || segmentCount == 0 || ringSize == 0) {
+        return;
+    }
+    bind(shader, false);
+    shader.set(uniforms.firstVertex, static_cast<int>(first));
+    shader.set(uniforms.ringSize, static_cast<int>(ringSize));
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(segmentCount));
+}
+
+void LineBuffer::DrawIndexed(Shader& shader) {
+    if (VAO == 0 || indexCount < 2) {
+        return;
+    }
+    bind(shader, true);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(indexCount - 1));
+}
@@ -0,0 +1,62 @@
+#ifndef LINE_BUFFER_H
+#define LINE_BUFFER_H
+
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include "Shader.h"
+
+// Index that ends one strip and starts the next in an indexed draw
+const unsigned int LINE_BREAK = 0xFFFFFFFFu;
+
+// Packs a colour into the 8-bit per channel format of the line colour buffer
+glm::u8vec4 PackLineColor(const glm::vec4& color);
+
+// Vertex storage for a thick polyline drawn by shaders/line_vertex.glsl. Vertices (position and width in
+// pixels) and colours are read through buffer textures, and every segment is one instance of a
+// screen-aligned quad, so a whole polyline is one draw call whatever glLineWidth supports.
+// GL objects are created by the first Reserve, so a LineBuffer can be built off the GL thread.
+class LineBuffer {
+public:
+    LineBuffer();
+    ~LineBuffer();
+    LineBuffer(const LineBuffer&) = delete;
+    LineBuffer& operator=(const LineBuffer&) = delete;
+
+    // Reallocates the vertex storage when it is smaller than vertexCount, growing it no further than the
+    // GL_MAX_TEXTURE_BUFFER_SIZE texels a buffer texture can address; contents are lost. Returns false
+    // when vertexCount does not fit, and callers must not draw vertices past GetCapacity().
+    bool Reserve(size_t vertexCount);
+    // positionWidths hold xyz plus the width in pixels; vertices past the capacity are dropped
+    void Update(size_t first, const glm::vec4* positionWidths, const glm::u8vec4* colors, size_t count);
+    // Replaces the indices used by DrawIndexed
+    void SetIndices(const std::vector<unsigned int>& indices);
+
+    // Draws segmentCount segments joining consecutive vertices from first on; vertex indices wrap at ringSize
+    void Draw(Shader& shader, size_t first, size_t segmentCount, size_t ringSize);
+    // Draws a segment between each pair of consecutive indices that are not LINE_BREAK
+    void DrawIndexed(Shader& shader);
+
+    size_t GetCapacity() const { return capacity; }
+
+private:
+    GLuint VAO;
+    GLuint vertexBuffer, colorBuffer, indexBuffer;
+    GLuint vertexTexture, colorTexture, indexTexture;
+    size_t capacity;      // In vertices
+    size_t indexCapacity;
+    size_t indexCount;
+
+    // Uniform handles of the shader last drawn with
+    struct Uniforms {
+        unsigned int program;
+        ShaderUniform<int> vertices, colors, indices, firstVertex, ringSize;
+        ShaderUniform<bool> indexed;
+    } uniforms;
+
+    void create();
+    void bind(Shader& shader, bool indexed);
+};
+
+#endif
@@ -1,111 +1,151 @@
 #include "Path.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-#include <pugixml/src/pugixml.hpp>
-#include <limits>
+#include "GpxReader.h"
 
-Path::Path(const std::string& gpxPath, const Terrain& terrain) {
-    if (!loadGPX(gpxPath)) {
-        std::cerr << "Error loading GPX file. Path will not be rendered.\n";
+Path::Path(const std::string& gpxPath, const Terrain& terrain) : Path() {
+    if (!Load(gpxPath)) {
         return;
     }
-    adjustPointsToTerrain(terrain);
-    setupPath();
+    PlaceOnTerrain(terrain);
+    Upload();
 }
 
-Path::~Path() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+Path::Path() : uploaded(false), lodEnabled(true), lodStats{ 0, 0, 0 } {
 }
 
-bool Path::loadGPX(const std::string& path) {
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(path.c_str());
-
-    if (!result) {
-        std::cerr << "Failed to load GPX file: " << path << "\n";
+bool Path::Load(const std::string& gpxPath) {
+    if (!loadGPX(gpxPath)) {
+        std::cerr << "Error loading GPX file. Path will not be rendered.\n";
         return false;
     }
+    return true;
+}
 
-    // Use XPath to select all 'trkpt' elements, regardless of namespace
-    pugi::xpath_node_set trkpts = doc.select_nodes("//*[local-name()='trkpt']");
-
-    if (trkpts.empty()) {
-        std::cerr << "No track points found in GPX file\n";
-        return false;
+void Path::PlaceOnTerrain(const Terrain& terrain) {
+    if (!pathPoints.empty()) {
+        adjustPointsToTerrain(terrain);
+        computeColors();
+        lod.Build(pathPoints);
     }
+}
 
-    for (pugi::xpath_node xpath_node : trkpts) {
-        pugi::xml_node trkpt = xpath_node.node();
-
-        double lat = trkpt.attribute("lat").as_double();
-        double lon = trkpt.attribute("lon").as_double();
-        double ele = 0.0;
+void Path::Upload() {
+    if (!uploaded && !pathPoints.empty()) {
+        setupPath();
+    }
+}
 
-        // Find 'ele' child regardless of namespace
-        pugi::xpath_node ele_node = trkpt.select_node("*[local-name()='ele']");
-        if (ele_node) {
-            ele = ele_node.node().text().as_double();
-        }
+bool Path::loadGPX(const std::string& path) {
+    // Parsed once, then loaded from the binary sidecar until the GPX file changes
+    if (!LoadTrackCached(path, projectedTrack)) {
+        return false;
+    }
 
-        pathPoints.emplace_back(static_cast<float>(lon), static_cast<float>(ele), static_cast<float>(lat));
+    if (projectedTrack.track.Empty()) {
+        std::cerr << "No track points found in GPX file\n";
+        return false;
     }
 
+    pathPoints.assign(projectedTrack.track.Size(), glm::vec3(0.0f));
     return true;
 }
 
 void Path::adjustPointsToTerrain(const Terrain& terrain) {
-    // Determine GPS bounds
-    double minLat = std::numeric_limits<double>::max();
-    double maxLat = std::numeric_limits<double>::lowest();
-    double minLon = std::numeric_limits<double>::max();
-    double maxLon = std::numeric_limits<double>::lowest();
-
-    // First pass to find bounds
-    for (const auto& point : pathPoints) {
-        minLat = std::min(minLat, static_cast<double>(point.z));
-        maxLat = std::max(maxLat, static_cast<double>(point.z));
-        minLon = std::min(minLon, static_cast<double>(point.x));
-        maxLon = std::max(maxLon, static_cast<double>(point.x));
-    }
-
     float terrainWidth = static_cast<float>(terrain.GetWidth());
     float terrainHeight = static_cast<float>(terrain.GetHeight());
 
-    // Calculate scaling factors
-    double scaleX = terrainWidth / (maxLon - minLon);
-    double scaleZ = terrainHeight / (maxLat - minLat);
+    // Stretch the projected track over the terrain: longitude along X, latitude along Z
+    std::vector<glm::vec2> groundPoints(pathPoints.size());
+    for (size_t i = 0; i < pathPoints.size(); ++i) {
+        const glm::vec2& projected = projectedTrack.projected[i];
+        glm::vec3& point = pathPoints[i];
+        point.x = projected.x * terrainWidth;
+        point.z = projected.y * terrainHeight;
+        groundPoints[i] = glm::vec2(point.x, point.z);
+    }
+
+    // Adjust Y coordinate based on terrain height, sampled in one batch
+    std::vector<float> terrainHeights;
+    terrain.SampleHeights(groundPoints, terrainHeights);
+    for (size_t i = 0; i < pathPoints.size(); ++i) {
+        pathPoints[i].y = terrainHeights[i] + 0.5f; // Offset above terrain
+    }
+}
 
-    // Adjust points to terrain coordinates
-    for (auto& point : pathPoints) {
-        point.x = static_cast<float>((point.x - minLon) * scaleX);
-        point.z = static_cast<float>((point.z - minLat) * scaleZ);
+// Heart rate from the 5th to the 95th percentile mapped cyan, yellow, red; cyan without heart rate
+void Path::computeColors() {
+    const glm::vec4 low(0.0f, 1.0f, 1.0f, 1.0f);
+    const glm::vec4 middle(1.0f, 1.0f, 0.0f, 1.0f);
+    const glm::vec4 high(1.0f, 0.0f, 0.0f, 1.0f);
+    pathColors.assign(pathPoints.size(), PackLineColor(low));
 
-        // Adjust Y coordinate based on terrain height
-        float terrainHeightAtPoint = terrain.GetHeightAt(point.x, point.z);
-        point.y = terrainHeightAtPoint + 0.5f; // Offset above terrain
+    const Track& track = projectedTrack.track;
+    if (!track.HasChannel(CHANNEL_HEART_RATE)) {
+        return;
+    }
+    const std::vector<float>& heartRates = track.GetChannel(CHANNEL_HEART_RATE);
+    std::vector<float> sorted;
+    for (float value : heartRates) {
+        if (!std::isnan(value)) {
+            sorted.push_back(value);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    float minimum = sorted[sorted.size() * 5 / 100];
+    float maximum = sorted[sorted.size() * 95 / 100];
+    float range = std::max(maximum - minimum, 1e-3f);
+
+    for (size_t i = 0; i < pathPoints.size(); ++i) {
+        if (std::isnan(heartRates[i])) {
+            continue;
+        }
+        float t = glm::clamp((heartRates[i] - minimum) / range, 0.0f, 1.0f);
+        glm::vec4 color = t < 0.5f ? glm::mix(low, middle, t * 2.0f) : glm::mix(middle, high, t * 2.0f - 1.0f);
+        pathColors[i] = PackLineColor(color);
     }
 }
 
 void Path::setupPath() {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, pathPoints.size() * sizeof(glm::vec3), pathPoints.data(), GL_STATIC_DRAW);
+    std::vector<glm::vec4> vertices(pathPoints.size());
+    for (size_t i = 0; i < pathPoints.size(); ++i) {
+        vertices[i] = glm::vec4(pathPoints[i], PATH_LINE_WIDTH);
+    }
+    // The LOD indices address every point, so a path past the buffer texture limit is not drawn
+    if (!lineBuffer.Reserve(vertices.size())) {
+        return;
+    }
+    lineBuffer.Update(0, vertices.data(), pathColors.data(), vertices.size());
+    uploaded = true;
+}
 
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
-    glEnableVertexAttribArray(0);
+void Path::Render(Shader& shader, const glm::mat4& viewProjection, const TerrainLODView& lodView) {
+    if (!uploaded) {
+        return;
+    }
 
-    glBindVertexArray(0);
-}
+    visibleStrips.clear();
+    lodStats = lod.Select(Frustum(viewProjection), lodView, lodEnabled, visibleStrips);
+
+    // Ranges share their end points, so neighbouring strips continue one line whatever their levels;
+    // a break separates strips with culled ranges between them
+    const std::vector<unsigned int>& indices = lod.GetIndices();
+    drawIndices.clear();
+    for (const PathLOD::Strip& strip : visibleStrips) {
+        const unsigned int* first = indices.data() + strip.firstIndex;
+        const unsigned int* last = first + strip.indexCount;
+        if (!drawIndices.empty() && drawIndices.back() == *first) {
+            ++first;
+        }
+        else if (!drawIndices.empty()) {
+            drawIndices.push_back(LINE_BREAK);
+        }
+        drawIndices.insert(drawIndices.end(), first, last);
+    }
 
-void Path::Render(Shader& shader) {
-    shader.Use();
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(pathPoints.size()));
-    glBindVertexArray(0);
+    lineBuffer.SetIndices(drawIndices);
+    lineBuffer.DrawIndexed(shader);
 }
 
 glm::vec3 Path::GetStartingPosition() const {
@@ -6,21 +6,56 @@
 #include <glm/glm.hpp>
 #include "Shader.h"
 #include "Terrain.h"
+#include "TrackCache.h"
+#include "PathLOD.h"
+#include "LineBuffer.h"
+
+// Width of the path line in pixels
+const float PATH_LINE_WIDTH = 3.0f;
 
 class Path {
 public:
+    // Loads, places and uploads the path on the calling thread
     Path(const std::string& gpxPath, const Terrain& terrain);
-    ~Path();
-    void Render(Shader& shader);
+
+    // Staged loading: Load and PlaceOnTerrain touch no GL state and can run on a worker thread
+    Path();
+    bool Load(const std::string& gpxPath);
+    void PlaceOnTerrain(const Terrain& terrain);
+    void Upload();
+
+    // Draws the ranges intersecting the view frustum, each at the level of detail chosen for its distance,
+    // as one thick line coloured by heart rate when the track has it
+    void Render(Shader& shader, const glm::mat4& viewProjection, const TerrainLODView& lodView);
     glm::vec3 GetStartingPosition() const;
 
+    // Level of detail selection; when disabled visible ranges are drawn at full resolution
+    void SetLODEnabled(bool enabled) { lodEnabled = enabled; }
+    bool IsLODEnabled() const { return lodEnabled; }
+    const PathLODStats& GetLODStats() const { return lodStats; }
+    const PathLOD& GetLOD() const { return lod; }
+    const std::vector<glm::vec3>& GetPoints() const { return pathPoints; }
+
+    // Everything recorded in the GPX file: time, position and sensor channels per point
+    const Track& GetTrack() const { return projectedTrack.track; }
+
 private:
-    GLuint VAO, VBO;
     std::vector<glm::vec3> pathPoints;
+    std::vector<glm::u8vec4> pathColors;
+    ProjectedTrack projectedTrack;
+    LineBuffer lineBuffer;
+    bool uploaded;
+
+    PathLOD lod;
+    bool lodEnabled;
+    PathLODStats lodStats;
+    std::vector<PathLOD::Strip> visibleStrips;
+    std::vector<unsigned int> drawIndices;
 
     bool loadGPX(const std::string& path);
     void setupPath();
     void adjustPointsToTerrain(const Terrain& terrain);
+    void computeColors();
 };
 
 #endif 
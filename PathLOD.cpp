@@ -0,0 +1,133 @@
+#include "PathLOD.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+struct Interval {
+    size_t start, end;
+    float parentError;
+};
+
+}
+
+float DistanceToSegment(const glm::vec3& point, const glm::vec3& start, const glm::vec3& end) {
+    glm::vec3 segment = end - start;
+    float lengthSquared = glm::dot(segment, segment);
+    float t = lengthSquared > 0.0f ? glm::clamp(glm::dot(point - start, segment) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+    return glm::length(point - (start + t * segment));
+}
+
+void ComputeDouglasPeuckerErrors(const std::vector<glm::vec3>& points, size_t first, size_t last, std::vector<float>& errors) {
+    errors.assign(last - first + 1, 0.0f);
+    errors.front() = FLT_MAX;
+    errors.back() = FLT_MAX;
+
+    // Split each interval at its farthest point as the recursive algorithm would. A point's significance is
+    // capped by its parent's so that coarser levels always keep a subset of the finer ones.
+    std::vector<Interval> stack;
+    stack.push_back({ first, last, FLT_MAX });
+    while (!stack.empty()) {
+        Interval interval = stack.back();
+        stack.pop_back();
+        if (interval.end - interval.start < 2) {
+            continue;
+        }
+
+        size_t farthest = interval.start + 1;
+        float farthestDistance = -1.0f;
+        for (size_t i = interval.start + 1; i < interval.end; ++i) {
+            float distance = DistanceToSegment(points[i], points[interval.start], points[interval.end]);
+            if (distance > farthestDistance) {
+                farthestDistance = distance;
+                farthest = i;
+            }
+        }
+
+        float error = std::min(farthestDistance, interval.parentError);
+        errors[farthest - first] = error;
+        stack.push_back({ interval.start, farthest, error });
+        stack.push_back({ farthest, interval.end, error });
+    }
+}
+
+PathLOD::PathLOD() : PixelTolerance(PATH_LOD_PIXEL_TOLERANCE) {
+}
+
+float PathLOD::GetLevelTolerance(int level) {
+    return level == 0 ? 0.0f : PATH_LOD_BASE_TOLERANCE * std::pow(3.0f, static_cast<float>(level - 1));
+}
+
+void PathLOD::Build(const std::vector<glm::vec3>& points, int rangePoints) {
+    ranges.clear();
+    strips.clear();
+    levelErrors.clear();
+    indices.clear();
+    if (points.empty()) {
+        return;
+    }
+
+    size_t step = static_cast<size_t>(std::max(rangePoints, 2));
+    size_t lastPoint = points.size() - 1;
+    std::vector<float> errors;
+    size_t first = 0;
+    do {
+        size_t last = std::min(first + step, lastPoint);
+
+        Range range;
+        range.firstPoint = static_cast<unsigned int>(first);
+        range.lastPoint = static_cast<unsigned int>(last);
+        range.bounds.min = points[first];
+        range.bounds.max = points[first];
+        for (size_t i = first + 1; i <= last; ++i) {
+            range.bounds.min = glm::min(range.bounds.min, points[i]);
+            range.bounds.max = glm::max(range.bounds.max, points[i]);
+        }
+        ranges.push_back(range);
+
+        ComputeDouglasPeuckerErrors(points, first, last, errors);
+        for (int level = 0; level < PATH_LOD_LEVEL_COUNT; ++level) {
+            float tolerance = GetLevelTolerance(level);
+            Strip strip;
+            strip.firstIndex = static_cast<unsigned int>(indices.size());
+            float levelError = 0.0f;
+            for (size_t i = first; i <= last; ++i) {
+                float error = errors[i - first];
+                if (error > tolerance) {
+                    indices.push_back(static_cast<unsigned int>(i));
+                }
+                else {
+                    levelError = std::max(levelError, error);
+                }
+            }
+            strip.indexCount = static_cast<unsigned int>(indices.size()) - strip.firstIndex;
+            strips.push_back(strip);
+            levelErrors.push_back(levelError);
+        }
+
+        first = last;
+    } while (first < lastPoint);
+}
+
+PathLODStats PathLOD::Select(const Frustum& frustum, const TerrainLODView& view, bool lodEnabled, std::vector<Strip>& visibleStrips) const {
+    PathLODStats stats = { 0, 0, 0 };
+    for (size_t r = 0; r < ranges.size(); ++r) {
+        if (!frustum.Intersects(ranges[r].bounds)) {
+            ++stats.culledRanges;
+            continue;
+        }
+
+        int level = 0;
+        if (lodEnabled) {
+            float distance = DistanceToAABB(view.position, ranges[r].bounds);
+            level = SelectTerrainLOD(GetLevelErrors(static_cast<int>(r)), PATH_LOD_LEVEL_COUNT, distance,
+                view.projectionScale, PixelTolerance);
+        }
+        const Strip& strip = GetStrip(static_cast<int>(r), level);
+        visibleStrips.push_back(strip);
+        ++stats.drawnRanges;
+        stats.drawnVertices += strip.indexCount;
+    }
+    return stats;
+}
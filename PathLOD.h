@@ -0,0 +1,70 @@
+#ifndef PATH_LOD_H
+#define PATH_LOD_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+#include "TerrainLOD.h"
+
+// Track points per independently simplified range; range endpoints are kept at every level
+const int PATH_LOD_RANGE_POINTS = 256;
+// Number of levels; level 0 keeps every point that is not exactly on the line
+const int PATH_LOD_LEVEL_COUNT = 6;
+// Douglas-Peucker tolerance of level 1 in world units; each coarser level triples it
+const float PATH_LOD_BASE_TOLERANCE = 0.05f;
+// Default screen-space error tolerance in pixels
+const float PATH_LOD_PIXEL_TOLERANCE = 1.0f;
+
+// Per-frame selection result
+struct PathLODStats {
+    int drawnRanges;
+    int culledRanges;
+    unsigned int drawnVertices;
+};
+
+// Distance from point to the segment start-end; a degenerate segment is treated as the point start
+float DistanceToSegment(const glm::vec3& point, const glm::vec3& start, const glm::vec3& end);
+
+// Douglas-Peucker significance of points[first + 1 .. last - 1]: a point is kept by the simplification
+// at tolerance t exactly when its significance is above t. Endpoints get FLT_MAX. Errors is resized to fit.
+void ComputeDouglasPeuckerErrors(const std::vector<glm::vec3>& points, size_t first, size_t last, std::vector<float>& errors);
+
+// Multi-resolution line strip for a GPX path. The path is cut into ranges, each simplified at several
+// nested tolerances, so every frame can draw near ranges in full and far ones coarsely. Pure CPU.
+class PathLOD {
+public:
+    struct Range {
+        AABB bounds;
+        unsigned int firstPoint;
+        unsigned int lastPoint; // Inclusive; shared with the next range so strips join without gaps
+    };
+
+    struct Strip {
+        unsigned int firstIndex;
+        unsigned int indexCount;
+    };
+
+    PathLOD();
+
+    void Build(const std::vector<glm::vec3>& points, int rangePoints = PATH_LOD_RANGE_POINTS);
+
+    // Appends the strip of every range intersecting the frustum at the coarsest level whose error stays
+    // within PixelTolerance; with lodEnabled false the visible ranges are drawn at level 0
+    PathLODStats Select(const Frustum& frustum, const TerrainLODView& view, bool lodEnabled, std::vector<Strip>& strips) const;
+
+    const Strip& GetStrip(int rangeIndex, int level) const { return strips[static_cast<size_t>(rangeIndex) * PATH_LOD_LEVEL_COUNT + level]; }
+    const std::vector<Range>& GetRanges() const { return ranges; }
+    const std::vector<unsigned int>& GetIndices() const { return indices; }
+    const float* GetLevelErrors(int rangeIndex) const { return &levelErrors[static_cast<size_t>(rangeIndex) * PATH_LOD_LEVEL_COUNT]; }
+    static float GetLevelTolerance(int level);
+
+    float PixelTolerance;
+
+private:
+    std::vector<Range> ranges;
+    std::vector<Strip> strips;          // rangeCount x PATH_LOD_LEVEL_COUNT
+    std::vector<float> levelErrors;     // rangeCount x PATH_LOD_LEVEL_COUNT, largest dropped significance
+    std::vector<unsigned int> indices;  // All strips back to back, as indices into the path points
+};
+
+#endif
@@ -1,27 +1,66 @@
 #include "PathTracer.h"
+#include <algorithm>
+
+namespace {
+
+// Smallest buffer allocated, in points
+const size_t PATH_TRACER_MIN_CAPACITY = 256;
 
-PathTracer::PathTracer() {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
 }
 
-void PathTracer::AddPoint(const glm::vec3& point) {
-    pathPoints.push_back(point);
-    updateBuffer();
+PathTracer::PathTracer(size_t maxPoints, PathTracer_Overflow overflow, float tolerance)
+    : trail(maxPoints, overflow, tolerance),
+    lineColor(PackLineColor(PATH_TRACER_DEFAULT_COLOR)), lineWidth(PATH_TRACER_DEFAULT_WIDTH), stats{ 0, 0, 0 } {
+}
+
+void PathTracer::SetStyle(const glm::vec4& color, float width) {
+    lineColor = PackLineColor(color);
+    lineWidth = width;
+    trail.MarkAllDirty();
 }
 
+// Uploads the changed range, growing the buffer geometrically up to the cap
 void PathTracer::updateBuffer() {
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, pathPoints.size() * sizeof(glm::vec3), pathPoints.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
-    glBindVertexArray(0);
+    size_t dirtyBegin, dirtyEnd;
+    if (!trail.TakeDirtyRange(dirtyBegin, dirtyEnd)) {
+        return;
+    }
+
+    const std::vector<glm::vec3>& pathPoints = trail.GetStorage();
+    size_t capacity = lineBuffer.GetCapacity();
+    if (pathPoints.size() > capacity) {
+        lineBuffer.Reserve(std::min(std::max(capacity * 2, std::max(pathPoints.size(), PATH_TRACER_MIN_CAPACITY)), trail.GetMaxPoints()));
+        if (lineBuffer.GetCapacity() != capacity) {
+            ++stats.reallocations;
+            dirtyBegin = 0;
+            dirtyEnd = pathPoints.size();
+        }
+    }
+    // Points past the buffer texture limit have nowhere to go
+    dirtyEnd = std::min(dirtyEnd, lineBuffer.GetCapacity());
+    if (dirtyBegin >= dirtyEnd) {
+        return;
+    }
+
+    // Width and colour are per vertex in the line buffer
+    size_t changed = dirtyEnd - dirtyBegin;
+    uploadVertices.resize(changed);
+    uploadColors.assign(changed, lineColor);
+    for (size_t i = 0; i < changed; ++i) {
+        uploadVertices[i] = glm::vec4(pathPoints[dirtyBegin + i], lineWidth);
+    }
+    lineBuffer.Update(dirtyBegin, uploadVertices.data(), uploadColors.data(), changed);
+    stats.bytesUploaded += changed * (sizeof(glm::vec4) + sizeof(glm::u8vec4));
+    ++stats.uploads;
 }
 
 void PathTracer::Render(Shader& shader) {
-    shader.Use();
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(pathPoints.size()));
-    glBindVertexArray(0);
+    updateBuffer();
+
+    // From the oldest point to the newest; once the ring is full the indices wrap at count. A trail
+    // capped above the buffer texture limit is not drawn rather than drawn through missing points.
+    size_t count = trail.GetCount();
+    if (count >= 2 && count <= lineBuffer.GetCapacity()) {
+        lineBuffer.Draw(shader, trail.GetHead(), count - 1, count);
+    }
 }
@@ -4,16 +4,54 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include "Shader.h"
+#include "LineBuffer.h"
+#include "PathTrail.h"
+
+// Default trail appearance; the width is in pixels
+const glm::vec4 PATH_TRACER_DEFAULT_COLOR(1.0f, 0.0f, 1.0f, 1.0f);
+const float PATH_TRACER_DEFAULT_WIDTH = 5.0f;
+
+// Upload counters
+struct PathTracerStats {
+    size_t bytesUploaded;
+    size_t uploads;
+    size_t reallocations;
+};
 
 class PathTracer {
 public:
-    PathTracer();
-    void AddPoint(const glm::vec3& point);
+    // A tolerance of 0 keeps every point
+    explicit PathTracer(size_t maxPoints = PATH_TRACER_DEFAULT_MAX_POINTS, PathTracer_Overflow overflow = OVERFLOW_DECIMATE,
+        float tolerance = PATH_TRACER_DEFAULT_TOLERANCE);
+    PathTracer(const PathTracer&) = delete;
+    PathTracer& operator=(const PathTracer&) = delete;
+
+    // Simplified as points arrive by the PathTrail; changes are uploaded on the next Render
+    void AddPoint(const glm::vec3& point) { trail.AddPoint(point); }
+    // Draws the trail as one thick line
     void Render(Shader& shader);
+    // Applies to the whole trail from the next Render
+    void SetStyle(const glm::vec4& color, float width);
+
+    // Trail vertices currently kept, oldest first
+    void GetPoints(std::vector<glm::vec3>& points) const { trail.GetPoints(points); }
+    size_t GetPointCount() const { return trail.GetCount(); }
+    size_t GetRawPointCount() const { return trail.GetStats().pointsAdded; }
+    const PathTrail& GetTrail() const { return trail; }
+    PathTrail& GetTrail() { return trail; }
+    const PathTracerStats& GetStats() const { return stats; }
 
 private:
-    std::vector<glm::vec3> pathPoints;
-    GLuint VAO, VBO;
+    // The line shader wraps vertex indices, so a full ring is drawn across the wrap in one draw
+    PathTrail trail;
+
+    LineBuffer lineBuffer;
+    glm::u8vec4 lineColor;
+    float lineWidth;
+    std::vector<glm::vec4> uploadVertices;
+    std::vector<glm::u8vec4> uploadColors;
+    PathTracerStats stats;
+
     void updateBuffer();
 };
 
@@ -0,0 +1,114 @@
+#include "PathTrail.h"
+#include <algorithm>
+#include "PathLOD.h"
+
+PathTrail::PathTrail(size_t maxPoints, PathTracer_Overflow overflow, float tolerance)
+    : maxPoints(std::max<size_t>(maxPoints, 4)), overflow(overflow), count(0), head(0),
+    tolerance(std::max(tolerance, 0.0f)), anchor(0.0f), dirtyBegin(0), dirtyEnd(0), stats{ 0, 0, 0 } {
+}
+
+void PathTrail::markDirty(size_t begin, size_t end) {
+    if (dirtyBegin == dirtyEnd) {
+        dirtyBegin = begin;
+        dirtyEnd = end;
+    }
+    else {
+        dirtyBegin = std::min(dirtyBegin, begin);
+        dirtyEnd = std::max(dirtyEnd, end);
+    }
+}
+
+bool PathTrail::TakeDirtyRange(size_t& begin, size_t& end) {
+    if (dirtyBegin == dirtyEnd) {
+        return false;
+    }
+    begin = dirtyBegin;
+    end = dirtyEnd;
+    dirtyBegin = dirtyEnd = 0;
+    return true;
+}
+
+void PathTrail::AddPoint(const glm::vec3& point) {
+    ++stats.pointsAdded;
+
+    // The first point is the first anchor, the second becomes the tip
+    if (stats.pointsAdded == 1) {
+        anchor = point;
+        pushVertex(point);
+        return;
+    }
+    if (pending.empty()) {
+        pending.push_back(point);
+        pushVertex(point);
+        return;
+    }
+
+    // Move the tip while the raw points since the anchor stay close to the straightened segment
+    if (tolerance > 0.0f && pending.size() < PATH_TRACER_MAX_PENDING && withinTolerance(point)) {
+        pending.push_back(point);
+        setLastVertex(point);
+        return;
+    }
+
+    // Otherwise the tip becomes a fixed vertex and the new point starts the next segment
+    anchor = pending.back();
+    pending.clear();
+    pending.push_back(point);
+    pushVertex(point);
+}
+
+bool PathTrail::withinTolerance(const glm::vec3& tip) const {
+    for (const glm::vec3& point : pending) {
+        if (DistanceToSegment(point, anchor, tip) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PathTrail::pushVertex(const glm::vec3& point) {
+    ++stats.verticesAdded;
+
+    if (count == maxPoints && overflow == OVERFLOW_DECIMATE) {
+        decimate();
+    }
+
+    if (count < maxPoints) {
+        pathPoints.push_back(point);
+        markDirty(count, count + 1);
+        ++count;
+        return;
+    }
+
+    // Full ring: the new point replaces the oldest
+    pathPoints[head] = point;
+    markDirty(head, head + 1);
+    head = (head + 1) % maxPoints;
+}
+
+// Overwrites the newest vertex
+void PathTrail::setLastVertex(const glm::vec3& point) {
+    size_t last = head == 0 ? count - 1 : head - 1;
+    pathPoints[last] = point;
+    markDirty(last, last + 1);
+}
+
+void PathTrail::GetPoints(std::vector<glm::vec3>& points) const {
+    points.clear();
+    points.reserve(count);
+    points.insert(points.end(), pathPoints.begin() + head, pathPoints.begin() + count);
+    points.insert(points.end(), pathPoints.begin(), pathPoints.begin() + head);
+}
+
+// Keeps every other point of the older half, so older history gets coarser each time the cap is hit
+void PathTrail::decimate() {
+    size_t olderHalf = count / 2;
+    size_t kept = 0;
+    for (size_t i = 0; i < olderHalf; i += 2) {
+        pathPoints[kept++] = pathPoints[i];
+    }
+    pathPoints.erase(pathPoints.begin() + kept, pathPoints.begin() + olderHalf);
+    count = pathPoints.size();
+    markDirty(0, count);
+    ++stats.decimations;
+}
@@ -0,0 +1,76 @@
+#ifndef PATH_TRAIL_H
+#define PATH_TRAIL_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Most points kept by default; 768 KB of positions
+const size_t PATH_TRACER_DEFAULT_MAX_POINTS = 65536;
+// Largest distance, in world units, between a recorded point and the simplified trail
+const float PATH_TRACER_DEFAULT_TOLERANCE = 0.1f;
+// Raw points checked against one trail segment at most; bounds the cost of AddPoint
+const size_t PATH_TRACER_MAX_PENDING = 512;
+
+// What happens once the trace holds its maximum number of points
+enum PathTracer_Overflow {
+    OVERFLOW_DECIMATE,    // Halve the resolution of the older half; the whole session stays visible
+    OVERFLOW_DROP_OLDEST  // Overwrite the oldest point; only the most recent stretch stays visible
+};
+
+// Simplification counters
+struct PathTrailStats {
+    size_t pointsAdded;     // Raw points passed to AddPoint
+    size_t verticesAdded;   // Trail vertices kept by the simplification, before the cap applies
+    size_t decimations;
+};
+
+// Point bookkeeping of the PathTracer: online simplification, the point cap and the dirty range
+// still to be uploaded. Pure CPU, so it runs without a GL context.
+class PathTrail {
+public:
+    // A tolerance of 0 keeps every point
+    explicit PathTrail(size_t maxPoints = PATH_TRACER_DEFAULT_MAX_POINTS, PathTracer_Overflow overflow = OVERFLOW_DECIMATE,
+        float tolerance = PATH_TRACER_DEFAULT_TOLERANCE);
+
+    // Simplified as points arrive: the trail keeps a vertex only where the path since the previous
+    // vertex would otherwise stray more than the tolerance
+    void AddPoint(const glm::vec3& point);
+
+    // Trail vertices currently kept, oldest first
+    void GetPoints(std::vector<glm::vec3>& points) const;
+    // Storage order: drawing order, or a ring whose oldest point is at GetHead() in OVERFLOW_DROP_OLDEST
+    const std::vector<glm::vec3>& GetStorage() const { return pathPoints; }
+    size_t GetHead() const { return head; }
+    size_t GetCount() const { return count; }
+    size_t GetMaxPoints() const { return maxPoints; }
+    float GetTolerance() const { return tolerance; }
+    const PathTrailStats& GetStats() const { return stats; }
+
+    // Storage range changed since the last call; false when nothing changed
+    bool TakeDirtyRange(size_t& begin, size_t& end);
+    void MarkAllDirty() { markDirty(0, pathPoints.size()); }
+
+private:
+    std::vector<glm::vec3> pathPoints;
+    size_t maxPoints;
+    PathTracer_Overflow overflow;
+    size_t count;
+    size_t head;  // Oldest point of the ring
+
+    // Online simplification: the last vertex is a floating tip that follows the newest point while
+    // every raw point since the anchor (the vertex before it) stays within tolerance of anchor-tip
+    float tolerance;
+    glm::vec3 anchor;
+    std::vector<glm::vec3> pending;  // Raw points after the anchor, ending with the tip
+
+    size_t dirtyBegin, dirtyEnd;
+    PathTrailStats stats;
+
+    bool withinTolerance(const glm::vec3& tip) const;
+    void pushVertex(const glm::vec3& point);
+    void setLastVertex(const glm::vec3& point);
+    void markDirty(size_t begin, size_t end);
+    void decimate();
+};
+
+#endif
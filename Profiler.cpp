@@ -0,0 +1,235 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+Profiler::Profiler() : enabled(false), inFrame(false), history(PROFILER_DEFAULT_HISTORY), frameIndex(0),
+    origin(std::chrono::steady_clock::now()), cpuDepth(0), gpuScopeOpen(false) {
+}
+
+Profiler::~Profiler() {
+    // Queries exist only if a frame was profiled, so there was a context
+    for (QuerySlot& slot : slots) {
+        if (!slot.queries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+        }
+    }
+}
+
+void Profiler::SetEnabled(bool enable) {
+    if (enabled && !enable) {
+        Flush();
+    }
+    enabled = enable;
+}
+
+void Profiler::SetHistory(size_t frameCount) {
+    history = std::max(frameCount, size_t(1));
+    while (frames.size() > history) {
+        frames.pop_front();
+    }
+}
+
+double Profiler::now() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+}
+
+int Profiler::passIndex(const char* name) {
+    for (size_t i = 0; i < passNames.size(); ++i) {
+        if (passNames[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    passNames.push_back(name);
+    return static_cast<int>(passNames.size() - 1);
+}
+
+void Profiler::BeginFrame() {
+    if (!enabled) {
+        return;
+    }
+    // The slot this frame reuses still holds the queries of PROFILER_QUERY_FRAMES frames ago
+    collect(slots[frameIndex % PROFILER_QUERY_FRAMES]);
+
+    ProfilerFrame frame;
+    frame.index = frameIndex;
+    frames.push_back(frame);
+    while (frames.size() > history) {
+        frames.pop_front();
+    }
+    inFrame = true;
+    cpuDepth = 0;
+    gpuScopeOpen = false;
+}
+
+void Profiler::EndFrame() {
+    if (!inFrame) {
+        return;
+    }
+    inFrame = false;
+    ++frameIndex;
+}
+
+void Profiler::Flush() {
+    for (QuerySlot& slot : slots) {
+        collect(slot);
+    }
+}
+
+int Profiler::beginScope(const char* name, bool gpu, bool& timed) {
+    timed = false;
+    if (!inFrame) {
+        return -1;
+    }
+    ProfilerFrame& frame = frames.back();
+    ProfilerEvent event = { passIndex(name), cpuDepth, now(), 0.0, -1.0 };
+    ++cpuDepth;
+
+    if (gpu && !gpuScopeOpen) {
+        QuerySlot& slot = slots[frameIndex % PROFILER_QUERY_FRAMES];
+        size_t queryIndex = slot.pending.size();
+        if (queryIndex == slot.queries.size()) {
+            GLuint query;
+            glGenQueries(1, &query);
+            slot.queries.push_back(query);
+        }
+        PendingQuery pending = { slot.queries[queryIndex], frameIndex, frame.events.size() };
+        slot.pending.push_back(pending);
+        glBeginQuery(GL_TIME_ELAPSED, pending.query);
+        gpuScopeOpen = true;
+        timed = true;
+    }
+    frame.events.push_back(event);
+    return static_cast<int>(frame.events.size() - 1);
+}
+
+void Profiler::endScope(int event, bool timed) {
+    if (event < 0 || !inFrame) {
+        return;
+    }
+    if (timed) {
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuScopeOpen = false;
+    }
+    ProfilerEvent& ended = frames.back().events[event];
+    ended.cpuMs = now() - ended.startMs;
+    --cpuDepth;
+}
+
+ProfilerFrame* Profiler::findFrame(uint64_t index) {
+    if (frames.empty() || index < frames.front().index) {
+        return nullptr;
+    }
+    size_t offset = static_cast<size_t>(index - frames.front().index);
+    if (offset >= frames.size() || frames[offset].index != index) {
+        return nullptr;
+    }
+    return &frames[offset];
+}
+
+void Profiler::collect(QuerySlot& slot) {
+    for (const PendingQuery& pending : slot.pending) {
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &elapsedNs);
+        // The frame may have left the history since
+        ProfilerFrame* frame = findFrame(pending.frame);
+        if (frame && pending.event < frame->events.size()) {
+            frame->events[pending.event].gpuMs = elapsedNs / 1.0e6;
+        }
+    }
+    slot.pending.clear();
+}
+
+Profiler::Scope::Scope(Profiler& profiler, const char* name, bool gpu) : profiler(profiler), event(-1), timed(false) {
+    if (profiler.inFrame) {
+        event = profiler.beginScope(name, gpu, timed);
+    }
+}
+
+Profiler::Scope::~Scope() {
+    profiler.endScope(event, timed);
+}
+
+void Profiler::GetSummary(std::vector<ProfilerPassSummary>& summary) const {
+    summary.clear();
+    size_t passCount = passNames.size();
+    std::vector<double> cpuTotals(passCount, 0.0), gpuTotals(passCount, 0.0);
+    std::vector<int> cpuFrames(passCount, 0), gpuFrames(passCount, 0);
+    std::vector<char> seen(passCount), timed(passCount);
+
+    // Per-frame totals of each pass, averaged over the frames that ran it
+    size_t first = frames.size() > PROFILER_SUMMARY_FRAMES ? frames.size() - PROFILER_SUMMARY_FRAMES : 0;
+    for (size_t i = first; i < frames.size(); ++i) {
+        std::fill(seen.begin(), seen.end(), 0);
+        std::fill(timed.begin(), timed.end(), 0);
+        for (const ProfilerEvent& event : frames[i].events) {
+            cpuTotals[event.pass] += event.cpuMs;
+            seen[event.pass] = 1;
+            if (event.gpuMs >= 0.0) {
+                gpuTotals[event.pass] += event.gpuMs;
+                timed[event.pass] = 1;
+            }
+        }
+        for (size_t pass = 0; pass < passCount; ++pass) {
+            cpuFrames[pass] += seen[pass];
+            gpuFrames[pass] += timed[pass];
+        }
+    }
+    for (size_t pass = 0; pass < passCount; ++pass) {
+        if (cpuFrames[pass] == 0) {
+            continue;
+        }
+        ProfilerPassSummary passSummary = { passNames[pass], cpuTotals[pass] / cpuFrames[pass],
+            gpuFrames[pass] > 0 ? gpuTotals[pass] / gpuFrames[pass] : -1.0 };
+        summary.push_back(passSummary);
+    }
+}
+
+void Profiler::PrintSummary(std::ostream& out) const {
+    std::vector<ProfilerPassSummary> summary;
+    GetSummary(summary);
+    char line[128];
+    std::snprintf(line, sizeof(line), "Profiler, mean of the last %zu frames:\n  %-16s %10s %10s\n",
+        std::min(frames.size(), PROFILER_SUMMARY_FRAMES), "pass", "cpu ms", "gpu ms");
+    out << line;
+    for (const ProfilerPassSummary& pass : summary) {
+        if (pass.gpuMs >= 0.0) {
+            std::snprintf(line, sizeof(line), "  %-16s %10.3f %10.3f\n", pass.name.c_str(), pass.cpuMs, pass.gpuMs);
+        }
+        else {
+            std::snprintf(line, sizeof(line), "  %-16s %10.3f %10s\n", pass.name.c_str(), pass.cpuMs, "-");
+        }
+        out << line;
+    }
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "ERROR::PROFILER::FAILED_TO_WRITE: " << path << std::endl;
+        return false;
+    }
+    // Timestamps and durations are in microseconds; pass names are string literals from the code
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"CPU\"}},\n";
+    out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"GPU\"}}";
+    char line[256];
+    for (const ProfilerFrame& frame : frames) {
+        for (const ProfilerEvent& event : frame.events) {
+            const char* name = passNames[event.pass].c_str();
+            std::snprintf(line, sizeof(line),
+                ",\n{\"name\": \"%s\", \"cat\": \"cpu\", \"ph\": \"X\", \"ts\": %.1f, \"dur\": %.1f, \"pid\": 1, \"tid\": 1, \"args\": {\"frame\": %llu}}",
+                name, event.startMs * 1000.0, event.cpuMs * 1000.0, static_cast<unsigned long long>(frame.index));
+            out << line;
+            if (event.gpuMs >= 0.0) {
+                std::snprintf(line, sizeof(line),
+                    ",\n{\"name\": \"%s\", \"cat\": \"gpu\", \"ph\": \"X\", \"ts\": %.1f, \"dur\": %.1f, \"pid\": 1, \"tid\": 2, \"args\": {\"frame\": %llu}}",
+                    name, event.startMs * 1000.0, event.gpuMs * 1000.0, static_cast<unsigned long long>(frame.index));
+                out << line;
+            }
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,114 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// GPU results are read this many frames after they were issued, so reading them does not wait on the
+// GPU; queries are kept in a ring of this many frames
+const int PROFILER_QUERY_FRAMES = 3;
+// Frames kept for the summary and the trace export
+const size_t PROFILER_DEFAULT_HISTORY = 1000;
+// Frames averaged by the rolling summary
+const size_t PROFILER_SUMMARY_FRAMES = 60;
+const char* const PROFILER_DEFAULT_TRACE = "profile_trace.json";
+
+// One scope of one frame. gpuMs is negative until its query has been read, or when the scope had none.
+struct ProfilerEvent {
+    int pass;         // Index into GetPassNames
+    int depth;        // Nesting depth of the CPU scope
+    double startMs;   // CPU time since the profiler was created
+    double cpuMs;
+    double gpuMs;
+};
+
+struct ProfilerFrame {
+    uint64_t index;
+    std::vector<ProfilerEvent> events;
+};
+
+// Rolling means over the last PROFILER_SUMMARY_FRAMES frames
+struct ProfilerPassSummary {
+    std::string name;
+    double cpuMs;
+    double gpuMs;   // Negative when no frame has a GPU result for the pass yet
+};
+
+// Scoped CPU markers with GL_TIME_ELAPSED queries around the draw passes of a frame. Time-elapsed
+// queries cannot nest, so only the outermost GPU scope is timed on the GPU; inner scopes are CPU only.
+class Profiler {
+public:
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // While disabled, frames and scopes cost a branch and record nothing
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return enabled; }
+    void SetHistory(size_t frames);
+
+    // Frame boundaries; BeginFrame collects the GPU results of the oldest frame in the query ring
+    void BeginFrame();
+    void EndFrame();
+    // Reads every outstanding query, waiting for the GPU; for the end of a run
+    void Flush();
+
+    class Scope {
+    public:
+        Scope(Profiler& profiler, const char* name, bool gpu = true);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Profiler& profiler;
+        int event;  // -1 when nothing is recorded
+        bool timed; // Holds the open GPU query
+    };
+
+    const std::vector<std::string>& GetPassNames() const { return passNames; }
+    const std::deque<ProfilerFrame>& GetFrames() const { return frames; }
+    void GetSummary(std::vector<ProfilerPassSummary>& summary) const;
+    void PrintSummary(std::ostream& out) const;
+
+    // Chrome trace event JSON, for chrome://tracing or Perfetto. CPU scopes go on one track and GPU
+    // durations on another, drawn from the CPU time their pass was issued.
+    bool WriteChromeTrace(const std::string& path) const;
+
+private:
+    struct PendingQuery {
+        GLuint query;
+        uint64_t frame;
+        size_t event;
+    };
+    struct QuerySlot {
+        std::vector<GLuint> queries;  // Grown on demand, reused every round of the ring
+        std::vector<PendingQuery> pending;
+    };
+
+    bool enabled;
+    bool inFrame;
+    size_t history;
+    uint64_t frameIndex;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<std::string> passNames;
+    std::deque<ProfilerFrame> frames;
+    QuerySlot slots[PROFILER_QUERY_FRAMES];
+    int cpuDepth;
+    bool gpuScopeOpen;
+
+    int passIndex(const char* name);
+    double now() const;
+    int beginScope(const char* name, bool gpu, bool& timed);
+    void endScope(int event, bool timed);
+    void collect(QuerySlot& slot);
+    ProfilerFrame* findFrame(uint64_t index);
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include "ProgramCache.h"
+#include "FileUtils.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// GL 4.1 / ARB_get_program_binary, not part of the 3.3 core loader
+const GLenum PROGRAM_BINARY_RETRIEVABLE_HINT = 0x8257;
+const GLenum PROGRAM_BINARY_LENGTH = 0x8741;
+const GLenum NUM_PROGRAM_BINARY_FORMATS = 0x87FE;
+
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+const char PROGRAM_CACHE_MAGIC[4] = { 'P', 'B', 'I', 'N' };
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+struct ProgramCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+};
+
+GetProgramBinaryProc getProgramBinary = nullptr;
+ProgramBinaryProc programBinary = nullptr;
+ProgramParameteriProc programParameteri = nullptr;
+std::string cacheDirectory;
+bool enabled = false;
+ProgramCacheStats stats = { 0, 0, 0, 0, 0.0, 0.0 };
+
+uint64_t hashString(uint64_t hash, const char* text) {
+    // Include the terminator so "ab" + "c" and "a" + "bc" differ
+    return text ? HashFnv1a(hash, text, std::strlen(text) + 1) : HashFnv1a(hash, "", 1);
+}
+
+std::string cachePath(uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return cacheDirectory + "/" + name;
+}
+
+} // namespace
+
+bool InitProgramCache(GLADloadproc load, const std::string& directory) {
+    getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(load("glGetProgramBinary"));
+    programBinary = reinterpret_cast<ProgramBinaryProc>(load("glProgramBinary"));
+    programParameteri = reinterpret_cast<ProgramParameteriProc>(load("glProgramParameteri"));
+    cacheDirectory = directory;
+    enabled = false;
+
+    if (!getProgramBinary || !programBinary || !programParameteri) {
+        return false;
+    }
+    GLint formats = 0;
+    glGetIntegerv(NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glGetError(); // GL_INVALID_ENUM on drivers without the extension
+    if (formats <= 0) {
+        return false;
+    }
+    if (!MakeDirectory(cacheDirectory)) {
+        std::cerr << "ERROR::PROGRAM_CACHE::FAILED_TO_CREATE_DIRECTORY: " << cacheDirectory << std::endl;
+        return false;
+    }
+    enabled = true;
+    return true;
+}
+
+bool IsProgramCacheEnabled() {
+    return enabled;
+}
+
+uint64_t ProgramCacheKey(const std::string& vertexSource, const std::string& fragmentSource) {
+    uint64_t hash = FNV1A_OFFSET_BASIS;
+    hash = HashFnv1a(hash, vertexSource.data(), vertexSource.size());
+    hash = HashFnv1a(hash, "\0", 1);
+    hash = HashFnv1a(hash, fragmentSource.data(), fragmentSource.size());
+    hash = HashFnv1a(hash, "\0", 1);
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    return hash;
+}
+
+GLuint LoadCachedProgram(uint64_t key) {
+    if (!enabled) {
+        return 0;
+    }
+
+    std::string path = cachePath(key);
+    std::ifstream in(path, std::ios::binary);
+    ProgramCacheHeader header;
+    if (!in || !in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, PROGRAM_CACHE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != PROGRAM_CACHE_VERSION || header.key != key) {
+        ++stats.misses;
+        return 0;
+    }
+    std::vector<char> binary(header.binaryLength);
+    if (!in.read(binary.data(), binary.size())) {
+        ++stats.misses;
+        return 0;
+    }
+    in.close();
+
+    // The driver may refuse a binary it wrote itself, e.g. after an update that kept the version string
+    GLuint program = glCreateProgram();
+    programBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        std::remove(path.c_str());
+        ++stats.rejected;
+        return 0;
+    }
+    ++stats.hits;
+    return program;
+}
+
+void PrepareProgramForCache(GLuint program) {
+    if (enabled) {
+        programParameteri(program, PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void StoreCachedProgram(uint64_t key, GLuint program) {
+    if (!enabled) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    getProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return;
+    }
+
+    ProgramCacheHeader header;
+    std::memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(header.magic));
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binaryFormat = format;
+    header.binaryLength = static_cast<uint32_t>(written);
+
+    // A crash never leaves a truncated binary behind
+    std::string path = cachePath(key);
+    bool stored = WriteFileAtomically(path, [&](std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), written);
+    });
+    if (!stored) {
+        std::cerr << "ERROR::PROGRAM_CACHE::FAILED_TO_WRITE: " << path << std::endl;
+        return;
+    }
+    ++stats.stored;
+}
+
+void RecordProgramBuild(bool cached, double milliseconds) {
+    if (cached) {
+        stats.cachedMs += milliseconds;
+    }
+    else {
+        stats.compiledMs += milliseconds;
+    }
+}
+
+const ProgramCacheStats& GetProgramCacheStats() {
+    return stats;
+}
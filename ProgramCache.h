@@ -0,0 +1,41 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <glad/glad.h>
+
+// Directory holding linked program binaries, one file per program
+const char* const PROGRAM_CACHE_DIRECTORY = "shader_cache";
+
+// Counters and time spent building programs, with and without the cache
+struct ProgramCacheStats {
+    int hits;
+    int misses;
+    int rejected;         // Binaries the driver refused to load; the program was compiled instead
+    int stored;
+    double cachedMs;      // Creating programs from binaries
+    double compiledMs;    // Compiling and linking from source, including storing the binary
+};
+
+// Loads the program binary entry points, which the GL 3.3 loader lacks, and creates the cache directory.
+// Call once after gladLoadGLLoader. Returns false and leaves the cache off when the driver offers no
+// binary formats; Shader then always compiles.
+bool InitProgramCache(GLADloadproc load, const std::string& directory = PROGRAM_CACHE_DIRECTORY);
+bool IsProgramCacheEnabled();
+
+// FNV-1a over both sources and the GL vendor, renderer and version, so a driver update misses
+uint64_t ProgramCacheKey(const std::string& vertexSource, const std::string& fragmentSource);
+
+// Creates a linked program from the cached binary, or returns 0 on a miss. A binary the driver rejects
+// is deleted so the next launch stores a fresh one.
+GLuint LoadCachedProgram(uint64_t key);
+// Call before glLinkProgram so the driver keeps the binary retrievable
+void PrepareProgramForCache(GLuint program);
+void StoreCachedProgram(uint64_t key, GLuint program);
+
+// Adds a program build to the timing totals
+void RecordProgramBuild(bool cached, double milliseconds);
+const ProgramCacheStats& GetProgramCacheStats();
+
+#endif
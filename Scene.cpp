@@ -0,0 +1,185 @@
+#include "Scene.h"
+#include <future>
+#include <iostream>
+#include <string>
+#include <glm/gtc/matrix_transform.hpp>
+#include "AssetLoader.h"
+#include "FileUtils.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+#include "TextureCompression.h"
+#include "ThreadPool.h"
+
+Scene::Scene() : terrain(TerrainOptions()), terrainModel{ -1 } {
+    dirLight.direction = glm::vec3(-0.7f, -1.0f, -0.7f);
+    dirLight.ambient = glm::vec3(0.4f);
+    dirLight.diffuse = glm::vec3(0.8f);
+    dirLight.specular = glm::vec3(1.0f);
+}
+
+void Scene::Load() {
+    // Nothing is known about the new context; each pass sets the depth and cull state it needs
+    ResetGLStateCache();
+    // Decides whether the loaders below may use compressed textures
+    InitTextureCompression();
+
+    StartupTimeline timeline;
+    ThreadPool loaderPool;
+
+    // Prefer a pre-tiled heightmap generated with --convert-heightmap, unless the PNG was edited since
+    const std::string heightmapPath = "assets/heightmaps/terrain_heightmap.png";
+    const std::string tiledHeightmapPath = "assets/heightmaps/terrain_heightmap.hmt";
+    bool useTiledHeightmap = IsDerivedFileCurrent(tiledHeightmapPath, heightmapPath);
+    if (!useTiledHeightmap && FileExists(tiledHeightmapPath)) {
+        std::cout << "Ignoring " << tiledHeightmapPath << ": older than " << heightmapPath << std::endl;
+    }
+
+    // Stages only wait on stages submitted before them
+    std::shared_future<bool> heightmapLoaded = loaderPool.Submit([&]() {
+        StartupTimeline::Scope stage(timeline, "terrain heightmap");
+        if (useTiledHeightmap) {
+            if (terrain.LoadHeightmap(tiledHeightmapPath)) {
+                return true;
+            }
+            std::cout << "Loading " << heightmapPath << " instead of " << tiledHeightmapPath << std::endl;
+        }
+        return terrain.LoadHeightmap(heightmapPath);
+    }).share();
+    std::shared_future<bool> gpxLoaded = loaderPool.Submit([&]() {
+        StartupTimeline::Scope stage(timeline, "gpx parse");
+        return path.Load("assets/gpx/hiking_path.gpx");
+    }).share();
+    std::shared_future<void> terrainMeshBuilt = loaderPool.Submit([&]() {
+        heightmapLoaded.wait();
+        StartupTimeline::Scope stage(timeline, "terrain mesh");
+        terrain.BuildMesh();
+    }).share();
+    std::future<void> pathPlaced = loaderPool.Submit([&]() {
+        heightmapLoaded.wait();
+        gpxLoaded.wait();
+        // The mesh build fills the tile cache of a tiled heightmap, which height queries also read
+        if (terrain.IsTiled()) {
+            terrainMeshBuilt.wait();
+        }
+        StartupTimeline::Scope stage(timeline, "path placement");
+        path.PlaceOnTerrain(terrain);
+    });
+    std::future<bool> terrainTextureLoaded = loaderPool.Submit([&]() {
+        StartupTimeline::Scope stage(timeline, "terrain texture");
+        return terrain.LoadTextureData("assets/textures/terrain_texture.png");
+    });
+    std::future<bool> grassTextureLoaded = loaderPool.Submit([&]() {
+        StartupTimeline::Scope stage(timeline, "grass texture");
+        return terrain.LoadGrassTextureData("assets/textures/grass_texture.png");
+    });
+    std::future<bool> skyDomeLoaded = loaderPool.Submit([&]() {
+        StartupTimeline::Scope stage(timeline, "sky dome");
+        return skyDome.LoadData("assets/skydome/sky_dome_texture.png");
+    });
+
+    // Build and compile shaders
+    StartupTimeline::Clock::time_point shaderStart = StartupTimeline::Clock::now();
+    terrainShader.reset(new Shader("shaders/terrain_vertex.glsl", "shaders/terrain_fragment.glsl"));
+    lineShader.reset(new Shader("shaders/line_vertex.glsl", "shaders/line_fragment.glsl"));
+    skyDomeShader.reset(new Shader("shaders/skydome_vertex.glsl", "shaders/skydome_fragment.glsl"));
+    timeline.Record("shader compile", shaderStart, StartupTimeline::Clock::now());
+    shaderWatcher.Watch(*terrainShader);
+    shaderWatcher.Watch(*lineShader);
+    shaderWatcher.Watch(*skyDomeShader);
+
+    // Camera and lights reach every program through the Frame and Lighting uniform blocks
+    frameUniforms.Create();
+    terrainModel = terrainShader->GetUniform<glm::mat4>("model");
+
+    // Upload each asset as soon as its CPU stages are done
+    skyDomeLoaded.wait();
+    {
+        StartupTimeline::Scope stage(timeline, "sky dome upload");
+        skyDome.Upload();
+    }
+    terrainTextureLoaded.wait();
+    grassTextureLoaded.wait();
+    terrainMeshBuilt.wait();
+    {
+        StartupTimeline::Scope stage(timeline, "terrain upload");
+        terrain.Upload();
+    }
+    pathPlaced.wait();
+    {
+        StartupTimeline::Scope stage(timeline, "path upload");
+        path.Upload();
+    }
+    timeline.Print(std::cout);
+    const ProgramCacheStats& programStats = GetProgramCacheStats();
+    if (IsProgramCacheEnabled()) {
+        std::cout << "Program cache: " << programStats.hits << " hits (" << programStats.cachedMs << " ms), "
+            << programStats.misses << " misses, " << programStats.rejected << " rejected ("
+            << programStats.compiledMs << " ms compiling)\n";
+    }
+    else {
+        std::cout << "Program cache: unavailable (" << programStats.compiledMs << " ms compiling)\n";
+    }
+    const TextureUploadStats& textureStats = GetTextureUploadStats();
+    std::cout << "Textures: " << textureStats.compressed << " compressed (" << textureStats.compressedBytes / 1024 << " KB), "
+        << textureStats.uncompressed << " uncompressed (" << textureStats.uncompressedBytes / 1024 << " KB)"
+        << (IsTextureCompressionEnabled() ? "" : "; S3TC unavailable") << "\n";
+}
+
+void Scene::UpdateShaders(bool reloadAll) {
+    if (reloadAll) {
+        shaderWatcher.ReloadAll();
+    }
+    // Terrain, lines and sky dome fetch their handles again when a program changes; this one is ours
+    if (shaderWatcher.Update() > 0) {
+        terrainModel = terrainShader->GetUniform<glm::mat4>("model");
+    }
+}
+
+void Scene::Render(Camera& camera, int width, int height) {
+    profiler.BeginFrame();
+    terrain.UpdateStreaming(camera.Position);
+
+    glm::mat4 view = camera.GetViewMatrix();
+    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom),
+        static_cast<float>(width) / static_cast<float>(height), 0.1f, 1000.0f);
+    {
+        Profiler::Scope scope(profiler, "frame setup");
+        // The sky dome leaves depth writes off and glClear honours the mask
+        SetDepthMask(true);
+        glClearColor(0.1f, 0.7f, 0.9f, 1.0f); // aqua color
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // Write the camera and lights once for all programs
+        frameUniforms.SetCamera(projection, view, camera.Position, glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+        frameUniforms.ClearLights();
+        frameUniforms.AddLight(dirLight);
+        frameUniforms.Upload();
+    }
+
+    // Render terrain
+    TerrainLODView lodView = MakeTerrainLODView(camera.Position, glm::radians(camera.Zoom), static_cast<float>(height));
+    {
+        Profiler::Scope scope(profiler, "terrain");
+        terrainShader->Use();
+        terrainShader->set(terrainModel, glm::mat4(1.0f));
+        terrain.Render(*terrainShader, projection * view, lodView);
+    }
+
+    // Render path from GPX and the path tracer as thick lines; colour and width come from the vertices
+    {
+        Profiler::Scope scope(profiler, "gpx path");
+        path.Render(*lineShader, projection * view, lodView);
+    }
+    {
+        Profiler::Scope scope(profiler, "path tracer");
+        pathTracer.Render(*lineShader);
+    }
+
+    // Render sky dome
+    {
+        Profiler::Scope scope(profiler, "sky dome");
+        skyDome.Render(*skyDomeShader);
+    }
+
+    profiler.EndFrame();
+}
@@ -0,0 +1,58 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <memory>
+#include "Camera.h"
+#include "Shader.h"
+#include "ShaderWatcher.h"
+#include "Terrain.h"
+#include "Path.h"
+#include "Profiler.h"
+#include "PathTracer.h"
+#include "SkyDome.h"
+#include "Light.h"
+#include "UniformBlocks.h"
+
+// Height of the walking camera above the ground
+const float SCENE_CAMERA_HEIGHT = 2.0f;
+
+// Terrain, GPX path, trail and sky with the programs and uniform buffers that draw them. Shared by the
+// interactive window and the headless benchmark so both render the same frame.
+class Scene {
+public:
+    Scene();
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    // Decodes assets and builds meshes on worker threads while the calling thread compiles shaders,
+    // then uploads everything. Needs a current GL context; prints the startup timeline.
+    void Load();
+
+    // Reloads shaders whose files changed, or all of them; call once per frame
+    void UpdateShaders(bool reloadAll);
+
+    // Pages in the terrain tiles around the camera, then clears and draws one frame into the bound
+    // framebuffer of the given size. Each pass is a profiler scope while the profiler is enabled.
+    void Render(Camera& camera, int width, int height);
+
+    Terrain& GetTerrain() { return terrain; }
+    Path& GetPath() { return path; }
+    PathTracer& GetPathTracer() { return pathTracer; }
+    Profiler& GetProfiler() { return profiler; }
+
+private:
+    Terrain terrain;
+    Path path;
+    SkyDome skyDome;
+    PathTracer pathTracer;
+    DirectionalLight dirLight;
+
+    // Built in Load, once a context exists
+    std::unique_ptr<Shader> terrainShader, lineShader, skyDomeShader;
+    ShaderWatcher shaderWatcher;
+    FrameUniforms frameUniforms;
+    ShaderUniform<glm::mat4> terrainModel;
+    Profiler profiler;
+};
+
+#endif
@@ -1,125 +1,405 @@
 #include "Shader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <cstdio>
+#include <vector>
+#include "UniformBlocks.h"
+#include "ProgramCache.h"
+#include "GLState.h"
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) : ID(0)
+#define STB_INCLUDE_IMPLEMENTATION
+#define STB_INCLUDE_LINE_GLSL
+#include <stb/stb_include.h>
+
+namespace {
+
+// KHR_parallel_shader_compile, not part of the 3.3 core loader
+const GLenum COMPLETION_STATUS_KHR = 0x91B1;
+
+bool readFile(const std::string& path, std::string& text)
 {
-    // Retrieve the vertex/fragment source code from file paths
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    // Ensure ifstream objects can throw exceptions
-    vShaderFile.exceptions(std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::badbit);
-    try
-    {
-        // Open shader files
-        vShaderFile.open(vertexPath);
-        if (!vShaderFile.is_open())
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    text = stream.str();
+    return true;
+}
+
+std::string directoryOf(const std::string& path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+// Appends the files named by #include "..." lines, recursively. stb_include resolves nested includes
+// against the directory of the top-level file too, so that is where they are looked up here.
+void collectIncludes(const std::string& text, const std::string& directory, std::vector<std::string>& files)
+{
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#')
         {
-            std::cerr << "ERROR::SHADER::VERTEX::FILE_NOT_OPENED: " << vertexPath << '\n';
-            return;
+            continue;
         }
-        fShaderFile.open(fragmentPath);
-        if (!fShaderFile.is_open())
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos || line.compare(pos, 7, "include") != 0)
         {
-            std::cerr << "ERROR::SHADER::FRAGMENT::FILE_NOT_OPENED: " << fragmentPath << '\n';
-            return;
+            continue;
+        }
+        size_t open = line.find('"', pos + 7);
+        size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+        if (close == std::string::npos)
+        {
+            continue;
+        }
+        std::string path = directory + "/" + line.substr(open + 1, close - open - 1);
+        if (std::find(files.begin(), files.end(), path) != files.end())
+        {
+            continue;
+        }
+        files.push_back(path);
+        std::string included;
+        if (readFile(path, included))
+        {
+            collectIncludes(included, directory, files);
+        }
+    }
+}
+
+// Reads a shader file and expands its includes; the #line directives stb_include inserts number the
+// included files as source strings 1, 2, ... so compile errors point at the right file and line
+bool loadShaderSource(const std::string& path, const char* stage, std::string& source, std::vector<std::string>& files)
+{
+    std::string text;
+    if (!readFile(path, text))
+    {
+        std::cerr << "ERROR::SHADER::" << stage << "::FILE_NOT_OPENED: " << path << '\n';
+        return false;
+    }
+    files.push_back(path);
+    std::string directory = directoryOf(path);
+    collectIncludes(text, directory, files);
+
+    // stb_include takes mutable strings but does not write to them
+    std::string fileName = path;
+    char error[256] = "";
+    char* expanded = stb_include_string(&text[0], nullptr, &directory[0], &fileName[0], error);
+    if (!expanded)
+    {
+        std::cerr << "ERROR::SHADER::" << stage << "::INCLUDE_FAILED: " << path << ": " << error << '\n';
+        return false;
+    }
+    source = expanded;
+    free(expanded);
+    return true;
+}
+
+bool parallelCompileAvailable()
+{
+    static int available = -1;
+    if (available < 0)
+    {
+        available = 0;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            std::string name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (name == "GL_KHR_parallel_shader_compile" || name == "GL_ARB_parallel_shader_compile")
+            {
+                available = 1;
+                break;
+            }
         }
-        std::stringstream vShaderStream, fShaderStream;
-        // Read file contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // Close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // Convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-    }
-    catch (std::ifstream::failure& e)
-    {
-        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << '\n';
-        return;
     }
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
+    return available == 1;
+}
+
+GLuint compileStage(GLenum type, const std::string& source)
+{
+    GLuint shader = glCreateShader(type);
+    const char* code = source.c_str();
+    glShaderSource(shader, 1, &code, NULL);
+    glCompileShader(shader);
+    return shader;
+}
 
-    // Compile shaders
-    unsigned int vertex, fragment;
+// Issues compile and link without reading back any status, so a parallel compiler is not waited on
+GLuint startBuild(const std::string& vertexCode, const std::string& fragmentCode, GLuint& vertex, GLuint& fragment)
+{
+    vertex = compileStage(GL_VERTEX_SHADER, vertexCode);
+    fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    PrepareProgramForCache(program);
+    glLinkProgram(program);
+    return program;
+}
+
+bool checkCompile(GLuint shader, const char* stage)
+{
     int success;
     char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED\n" << infoLog << '\n';
+    }
+    return success != 0;
+}
 
-    // Vertex Shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    // Check for compilation errors
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+// Reports compile and link errors and deletes the stages; a program that failed is deleted too
+bool finishBuild(GLuint program, GLuint vertex, GLuint fragment)
+{
+    bool compiled = checkCompile(vertex, "VERTEX") && checkCompile(fragment, "FRAGMENT");
+    int success = 0;
+    if (compiled)
+    {
+        char infoLog[512];
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glGetProgramInfoLog(program, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << '\n';
+        }
+    }
+
+    // Delete the shaders as they're linked into the program now and no longer necessary
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
     if (!success)
     {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << '\n';
+        glDeleteProgram(program);
+    }
+    return success != 0;
+}
+
+} // namespace
+
+unsigned int Shader::uniformCalls = 0;
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath)
+    : ID(0), vertexPath(vertexPath), fragmentPath(fragmentPath), pendingProgram(0), pendingVertex(0),
+    pendingFragment(0), pendingKey(0)
+{
+    // Retrieve the vertex/fragment source code from file paths, with includes expanded
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!readSources(vertexCode, fragmentCode))
+    {
         return;
     }
 
-    // Fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    // Check for compilation errors
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success)
+    // Reuse the program binary of an earlier launch when the sources and driver are unchanged
+    std::chrono::steady_clock::time_point buildStart = std::chrono::steady_clock::now();
+    uint64_t cacheKey = ProgramCacheKey(vertexCode, fragmentCode);
+    ID = LoadCachedProgram(cacheKey);
+    if (ID != 0)
     {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << '\n';
+        RecordProgramBuild(true, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count());
+        setupProgram();
         return;
     }
 
-    // Shader Program
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
-    // Check for linking errors
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success)
+    // Compile and link
+    GLuint vertex, fragment;
+    GLuint program = startBuild(vertexCode, fragmentCode, vertex, fragment);
+    if (!finishBuild(program, vertex, fragment))
     {
-        glGetProgramInfoLog(ID, 512, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << '\n';
         return;
     }
+    ID = program;
 
-    // Delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    StoreCachedProgram(cacheKey, ID);
+    RecordProgramBuild(false, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count());
+    setupProgram();
+}
+
+bool Shader::readSources(std::string& vertexCode, std::string& fragmentCode)
+{
+    std::vector<std::string> files;
+    if (!loadShaderSource(vertexPath, "VERTEX", vertexCode, files)
+        || !loadShaderSource(fragmentPath, "FRAGMENT", fragmentCode, files))
+    {
+        return false;
+    }
+    sourceFiles = files;
+    return true;
+}
+
+bool Shader::Reload()
+{
+    // A newer edit supersedes a build still in flight
+    if (pendingProgram != 0)
+    {
+        glDeleteProgram(pendingProgram);
+        if (pendingVertex != 0)
+        {
+            glDeleteShader(pendingVertex);
+            glDeleteShader(pendingFragment);
+        }
+        pendingProgram = pendingVertex = pendingFragment = 0;
+    }
+
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!readSources(vertexCode, fragmentCode))
+    {
+        return false;
+    }
+
+    // Undoing an edit usually finds the earlier binary
+    pendingKey = ProgramCacheKey(vertexCode, fragmentCode);
+    pendingProgram = LoadCachedProgram(pendingKey);
+    if (pendingProgram == 0)
+    {
+        pendingProgram = startBuild(vertexCode, fragmentCode, pendingVertex, pendingFragment);
+    }
+    return true;
 }
 
+bool Shader::PollReload()
+{
+    if (pendingProgram == 0)
+    {
+        return false;
+    }
+    bool compiled = pendingVertex != 0;
+    if (compiled)
+    {
+        if (parallelCompileAvailable())
+        {
+            GLint done = GL_TRUE;
+            glGetProgramiv(pendingProgram, COMPLETION_STATUS_KHR, &done);
+            if (!done)
+            {
+                return false;
+            }
+        }
+        if (!finishBuild(pendingProgram, pendingVertex, pendingFragment))
+        {
+            std::cerr << "ERROR::SHADER::RELOAD_FAILED: keeping the previous program for " << vertexPath
+                << " and " << fragmentPath << '\n';
+            pendingProgram = pendingVertex = pendingFragment = 0;
+            return false;
+        }
+        StoreCachedProgram(pendingKey, pendingProgram);
+    }
+
+    // GL defers deleting the old program while it is still current
+    if (ID != 0)
+    {
+        DeleteProgram(ID);
+    }
+    ID = pendingProgram;
+    pendingProgram = pendingVertex = pendingFragment = 0;
+    setupProgram();
+    std::cout << "Reloaded " << vertexPath << " and " << fragmentPath << '\n';
+    return true;
+}
+
+// Link-time state that a program binary does not carry over
+void Shader::setupProgram()
+{
+    reflectUniforms();
+    BindUniformBlock(FRAME_BLOCK_NAME, FRAME_BLOCK_BINDING);
+    BindUniformBlock(LIGHTING_BLOCK_NAME, LIGHTING_BLOCK_BINDING);
+}
+
+bool Shader::BindUniformBlock(const char* blockName, GLuint binding)
+{
+    GLuint index = glGetUniformBlockIndex(ID, blockName);
+    if (index == GL_INVALID_INDEX)
+    {
+        return false;
+    }
+    glUniformBlockBinding(ID, index, binding);
+    return true;
+}
+
+// Records the location of every active uniform so setting one never asks the driver
+void Shader::reflectUniforms()
+{
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> nameBuffer(static_cast<size_t>(std::max(maxLength, 1)));
+
+    uniformLocations.clear();
+    for (GLint i = 0; i < count; ++i)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), maxLength, &length, &size, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), static_cast<size_t>(length));
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        if (location < 0)
+        {
+            continue; // Member of a uniform block
+        }
+        uniformLocations[name] = location;
+
+        // Arrays are reported as "name[0]"; also accept the bare name like glGetUniformLocation does
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+        {
+            uniformLocations[name.substr(0, name.size() - 3)] = location;
+        }
+    }
+}
+
+GLint Shader::GetUniformLocation(const std::string& name) const
+{
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+// Skipped by the state cache when the program is already in use
 void Shader::Use()
 {
-    glUseProgram(ID);
+    UseProgram(ID);
 }
 
 void Shader::setBool(const std::string& name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    ++uniformCalls;
+    upload(GetUniformLocation(name), value);
 }
 void Shader::setInt(const std::string& name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    ++uniformCalls;
+    upload(GetUniformLocation(name), value);
 }
 void Shader::setFloat(const std::string& name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    ++uniformCalls;
+    upload(GetUniformLocation(name), value);
+}
+void Shader::setVec2(const std::string& name, glm::vec2 value) const
+{
+    ++uniformCalls;
+    upload(GetUniformLocation(name), value);
 }
 void Shader::setVec3(const std::string& name, glm::vec3 value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    ++uniformCalls;
+    upload(GetUniformLocation(name), value);
 }
 void Shader::setMat4(const std::string& name, glm::mat4 value) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+    ++uniformCalls;
+    upload(GetUniformLocation(name), value);
 }
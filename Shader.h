@@ -1,27 +1,95 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+// Uniform location resolved once, typed by the value it takes. Location -1 (not an active uniform)
+// is ignored by GL, so a handle for a uniform the compiler optimised out is safe to set.
+template <typename T>
+struct ShaderUniform
+{
+    GLint location;
+};
+
 class Shader
 {
 public:
     unsigned int ID;
 
-    // Constructor reads and builds the shader
+    // Constructor reads and builds the shader. Sources may #include "file" relative to their own
+    // directory; includes are expanded with stb_include.
     Shader(const char* vertexPath, const char* fragmentPath);
 
+    // Starts rebuilding the program from its files; PollReload finishes it. On drivers with
+    // KHR_parallel_shader_compile the compile and link run on driver threads in the meantime.
+    // Returns false if the sources could not be read. The current program stays in use until the swap.
+    bool Reload();
+    // Swaps in the reloaded program once it has linked and returns true. A program that fails to
+    // compile or link is dropped with its log and the current one kept. Uniform values start over
+    // and handles must be fetched again after a swap.
+    bool PollReload();
+    bool IsReloading() const { return pendingProgram != 0; }
+
+    // Shader files and every file they include, as read by the last successful read
+    const std::vector<std::string>& GetSourceFiles() const { return sourceFiles; }
+
     // Use the shader
     void Use();
 
-    // Utility uniform functions
+    // Points a uniform block at a binding point; false if the program has no such active block.
+    // The Frame and Lighting blocks are bound when the program is linked.
+    bool BindUniformBlock(const char* blockName, GLuint binding);
+
+    // Location of an active uniform from the table built at link time, or -1
+    GLint GetUniformLocation(const std::string& name) const;
+    template <typename T>
+    ShaderUniform<T> GetUniform(const std::string& name) const { return ShaderUniform<T>{ GetUniformLocation(name) }; }
+
+    // Sets a uniform of the program in use through a handle; no lookup or allocation
+    template <typename T>
+    void set(const ShaderUniform<T>& uniform, const T& value) const
+    {
+        ++uniformCalls;
+        upload(uniform.location, value);
+    }
+
+    // Uniform sets since the last reset, across all shaders; main resets it every frame
+    static unsigned int GetUniformCallCount() { return uniformCalls; }
+    static void ResetUniformCallCount() { uniformCalls = 0; }
+
+    // Utility uniform functions; these look the name up in the uniform table
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
     void setFloat(const std::string& name, float value) const;
+    void setVec2(const std::string& name, glm::vec2 value) const;
     void setVec3(const std::string& name, glm::vec3 value) const;
     void setMat4(const std::string& name, glm::mat4 value) const;
+
+private:
+    std::unordered_map<std::string, GLint> uniformLocations;
+    static unsigned int uniformCalls;
+
+    std::string vertexPath, fragmentPath;
+    std::vector<std::string> sourceFiles;
+    // Reload in flight; the stages are 0 when the program came from the program cache
+    GLuint pendingProgram, pendingVertex, pendingFragment;
+    uint64_t pendingKey;
+
+    bool readSources(std::string& vertexCode, std::string& fragmentCode);
+    void setupProgram();
+    void reflectUniforms();
+
+    static void upload(GLint location, bool value) { glUniform1i(location, static_cast<int>(value)); }
+    static void upload(GLint location, int value) { glUniform1i(location, value); }
+    static void upload(GLint location, float value) { glUniform1f(location, value); }
+    static void upload(GLint location, const glm::vec2& value) { glUniform2fv(location, 1, &value[0]); }
+    static void upload(GLint location, const glm::vec3& value) { glUniform3fv(location, 1, &value[0]); }
+    static void upload(GLint location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]); }
 };
 
 #endif
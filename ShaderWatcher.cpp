@@ -0,0 +1,124 @@
+#include "ShaderWatcher.h"
+#include "Shader.h"
+#include <algorithm>
+#include <iostream>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+} // namespace
+
+ShaderWatcher::ShaderWatcher() : inotifyFd(-1) {
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        std::cerr << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED: errno " << errno << std::endl;
+    }
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher() {
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+void ShaderWatcher::Watch(Shader& shader) {
+    shaders.push_back(&shader);
+    watchDirectories(shader);
+}
+
+bool ShaderWatcher::IsWatchingFiles() const {
+    return inotifyFd >= 0;
+}
+
+// Directories rather than files are watched: editors often save by writing a new file and renaming it
+// over the old one, which would end a watch on the file itself
+void ShaderWatcher::watchDirectories(const Shader& shader) {
+#ifdef __linux__
+    if (inotifyFd < 0) {
+        return;
+    }
+    for (const std::string& file : shader.GetSourceFiles()) {
+        std::string directory = directoryOf(file);
+        // Adding an existing watch returns its descriptor again
+        int wd = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            std::cerr << "ERROR::SHADER_WATCHER::FAILED_TO_WATCH: " << directory << std::endl;
+            continue;
+        }
+        directories[wd] = directory;
+    }
+#endif
+}
+
+void ShaderWatcher::readEvents(std::vector<std::string>& changedFiles) {
+#ifdef __linux__
+    if (inotifyFd < 0) {
+        return;
+    }
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return; // EAGAIN: no more events
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+            auto directory = directories.find(event->wd);
+            if (event->len == 0 || directory == directories.end()) {
+                continue;
+            }
+            std::string path = directory->second + "/" + event->name;
+            if (std::find(changedFiles.begin(), changedFiles.end(), path) == changedFiles.end()) {
+                changedFiles.push_back(path);
+            }
+        }
+    }
+#else
+    (void)changedFiles;
+#endif
+}
+
+int ShaderWatcher::Update() {
+    // One reload per shader however many of its files a save touched
+    std::vector<std::string> changedFiles;
+    readEvents(changedFiles);
+    for (Shader* shader : shaders) {
+        const std::vector<std::string>& files = shader->GetSourceFiles();
+        for (const std::string& changed : changedFiles) {
+            if (std::find(files.begin(), files.end(), changed) != files.end()) {
+                if (shader->Reload()) {
+                    watchDirectories(*shader); // An edit may have added an include
+                }
+                break;
+            }
+        }
+    }
+
+    int swapped = 0;
+    for (Shader* shader : shaders) {
+        if (shader->PollReload()) {
+            ++swapped;
+        }
+    }
+    return swapped;
+}
+
+void ShaderWatcher::ReloadAll() {
+    for (Shader* shader : shaders) {
+        shader->Reload();
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+class Shader;
+
+// Reloads shaders when one of their files, including #included ones, is saved. On Linux the shader
+// directories are watched with inotify; elsewhere only ReloadAll triggers a reload.
+class ShaderWatcher {
+public:
+    ShaderWatcher();
+    ~ShaderWatcher();
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // The shader must outlive the watcher
+    void Watch(Shader& shader);
+
+    // Reads file events without blocking, starts reloading the shaders whose files changed and swaps
+    // in the reloads that have finished linking. Call once per frame with the GL context current.
+    // Returns the number of shaders swapped; their uniform handles must be fetched again.
+    int Update();
+
+    void ReloadAll();
+
+    // False when file events are unavailable on this platform or inotify could not be set up
+    bool IsWatchingFiles() const;
+
+private:
+    std::vector<Shader*> shaders;
+    int inotifyFd;
+    std::map<int, std::string> directories;  // Watch descriptor -> directory
+
+    void watchDirectories(const Shader& shader);
+    void readEvents(std::vector<std::string>& changedFiles);
+};
+
+#endif
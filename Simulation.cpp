@@ -0,0 +1,77 @@
+#include "Simulation.h"
+#include <algorithm>
+
+void SampleTrail(PathTrail& trail, glm::vec3& lastTrailPosition, const glm::vec3& position) {
+    if (glm::length(position - lastTrailPosition) > SIMULATION_TRAIL_SPACING) {
+        trail.AddPoint(position);
+        lastTrailPosition = position;
+    }
+}
+
+Simulation::Simulation(Scene& scene)
+    : Simulation([&scene](float x, float z) { return scene.GetTerrain().GetHeightAt(x, z); },
+        glm::vec2(scene.GetTerrain().GetWidth() - 1, scene.GetTerrain().GetHeight() - 1), scene.GetPathTracer().GetTrail()) {
+    this->scene = &scene;
+}
+
+Simulation::Simulation(const SimulationHeightFunction& groundHeight, const glm::vec2& extent, PathTrail& trail)
+    : scene(nullptr), groundHeight(groundHeight), extent(extent), trail(trail), previousPosition(0.0f), currentPosition(0.0f), lastTrailPosition(0.0f), accumulator(0.0f), stepCount(0) {
+}
+
+void Simulation::Reset(const Camera& camera) {
+    previousPosition = camera.Position;
+    currentPosition = camera.Position;
+    lastTrailPosition = camera.Position;
+    accumulator = 0.0f;
+    trail.AddPoint(camera.Position);
+}
+
+int Simulation::Advance(const InputFrame& input, Camera& camera) {
+    if (input.mouseX != 0.0f || input.mouseY != 0.0f) {
+        camera.ProcessMouseMovement(input.mouseX, input.mouseY);
+    }
+    if ((input.keys & INPUT_KEY_TOGGLE_LOD) && scene) {
+        Terrain& terrain = scene->GetTerrain();
+        terrain.SetLODEnabled(!terrain.IsLODEnabled());
+        scene->GetPath().SetLODEnabled(terrain.IsLODEnabled());
+    }
+
+    accumulator += std::min(std::max(input.deltaTime, 0.0f), SIMULATION_MAX_STEPS * SIMULATION_TIMESTEP);
+    int steps = 0;
+    while (accumulator >= SIMULATION_TIMESTEP) {
+        step(input.keys, camera);
+        accumulator -= SIMULATION_TIMESTEP;
+        ++steps;
+    }
+    stepCount += steps;
+
+    camera.Position = glm::mix(previousPosition, currentPosition, GetInterpolation());
+    return steps;
+}
+
+void Simulation::step(uint8_t keys, Camera& camera) {
+    previousPosition = currentPosition;
+    camera.Position = currentPosition;
+    if (keys & INPUT_KEY_FORWARD) {
+        camera.ProcessKeyboard(FORWARD, SIMULATION_TIMESTEP);
+    }
+    if (keys & INPUT_KEY_BACKWARD) {
+        camera.ProcessKeyboard(BACKWARD, SIMULATION_TIMESTEP);
+    }
+    if (keys & INPUT_KEY_LEFT) {
+        camera.ProcessKeyboard(LEFT, SIMULATION_TIMESTEP);
+    }
+    if (keys & INPUT_KEY_RIGHT) {
+        camera.ProcessKeyboard(RIGHT, SIMULATION_TIMESTEP);
+    }
+    followGround(camera);
+    currentPosition = camera.Position;
+
+    SampleTrail(trail, lastTrailPosition, currentPosition);
+}
+
+void Simulation::followGround(Camera& camera) const {
+    camera.Position.x = glm::clamp(camera.Position.x, 0.0f, extent.x);
+    camera.Position.z = glm::clamp(camera.Position.z, 0.0f, extent.y);
+    camera.Position.y = groundHeight(camera.Position.x, camera.Position.z) + SCENE_CAMERA_HEIGHT;
+}
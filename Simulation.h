@@ -0,0 +1,64 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <functional>
+#include <glm/glm.hpp>
+#include "Camera.h"
+#include "InputRecording.h"
+#include "PathTrail.h"
+#include "Scene.h"
+
+// Length of one simulation step in seconds, independent of the frame rate
+const float SIMULATION_TIMESTEP = 1.0f / 60.0f;
+// Most steps taken for one frame; after a longer stall the walker slows down instead of catching up
+const int SIMULATION_MAX_STEPS = 8;
+// Distance the walker moves before the trail gets a new point
+const float SIMULATION_TRAIL_SPACING = 0.5f;
+
+// Adds position to the trail once it is more than SIMULATION_TRAIL_SPACING from lastTrailPosition,
+// and moves lastTrailPosition there. Anything that extends the trail uses it, so trails cost the same.
+void SampleTrail(PathTrail& trail, glm::vec3& lastTrailPosition, const glm::vec3& position);
+
+// Ground height at world (x, z)
+typedef std::function<float(float, float)> SimulationHeightFunction;
+
+// Walks the camera over the terrain in fixed steps. Movement, the terrain height snap and trail
+// sampling run once per step, so their cost does not grow with the frame rate; the rendered position
+// is interpolated between the last two steps. Mouse look and toggles apply at once, every frame.
+class Simulation {
+public:
+    // Walks over the scene's loaded terrain, extends its path tracer and toggles its level of detail
+    explicit Simulation(Scene& scene);
+    // Walks over groundHeight within [0, extent.x] x [0, extent.y] and extends trail; without a scene
+    // the level of detail toggle does nothing
+    Simulation(const SimulationHeightFunction& groundHeight, const glm::vec2& extent, PathTrail& trail);
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Starts walking from the camera's position and begins the trail there
+    void Reset(const Camera& camera);
+
+    // Adds the frame's deltaTime and runs every whole step it completes, moving by the held keys.
+    // Leaves the camera at the interpolated position and returns the number of steps taken.
+    int Advance(const InputFrame& input, Camera& camera);
+
+    // How far the rendered position is from the previous step towards the current one, in [0, 1)
+    float GetInterpolation() const { return accumulator / SIMULATION_TIMESTEP; }
+    long long GetStepCount() const { return stepCount; }
+
+private:
+    Scene* scene;  // Null without a scene
+    SimulationHeightFunction groundHeight;
+    glm::vec2 extent;
+    PathTrail& trail;
+    glm::vec3 previousPosition, currentPosition;
+    glm::vec3 lastTrailPosition;
+    float accumulator;
+    long long stepCount;
+
+    void step(uint8_t keys, Camera& camera);
+    // Keeps the camera within the extent at SCENE_CAMERA_HEIGHT above the ground
+    void followGround(Camera& camera) const;
+};
+
+#endif
@@ -1,23 +1,52 @@
 #include "SkyDome.h"
-#include <stb/stb_image.h>
+#include "GLState.h"
 #include <vector>
 #include <iostream>
 #include <glm/gtc/constants.hpp>
 
-SkyDome::SkyDome(const std::string& texturePath) {
+SkyDome::SkyDome(const std::string& texturePath) : SkyDome() {
+    LoadData(texturePath);
+    Upload();
+}
+
+SkyDome::SkyDome() : VAO(0), VBO(0), EBO(0), textureID(0), indexCount(0),
+    uniformProgram(0), textureUniform{ -1 } {
+}
+
+bool SkyDome::LoadData(const std::string& texturePath) {
     generateSphereMesh(50, 50);
-    loadTexture(texturePath);
+    if (!LoadImageData(texturePath, false, image)) {
+        std::cerr << "Sky dome texture failed to load at path: " << texturePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void SkyDome::Upload() {
+    if (VAO == 0 && !indices.empty()) {
+        uploadMesh();
+    }
+    if (image.IsValid()) {
+        DeleteTextures(1, &textureID);
+        textureID = CreateTexture2D(image, GL_REPEAT, GL_CLAMP_TO_EDGE); // Wrap around, clamp to prevent seams
+        image = ImageData();
+    }
 }
 
 SkyDome::~SkyDome() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    if (VAO != 0) {
+        DeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+    if (textureID != 0) {
+        DeleteTextures(1, &textureID);
+    }
 }
 
 void SkyDome::generateSphereMesh(unsigned int latitudeBands, unsigned int longitudeBands) {
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+    vertices.clear();
+    indices.clear();
 
     float radius = 250.0f;
 
@@ -64,13 +93,15 @@ void SkyDome::generateSphereMesh(unsigned int latitudeBands, unsigned int longit
     }
 
     indexCount = static_cast<unsigned int>(indices.size());
+}
 
+void SkyDome::uploadMesh() {
     // Create buffers
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
 
-    glBindVertexArray(VAO);
+    BindVertexArray(VAO);
 
     // Vertex buffer
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -89,61 +120,26 @@ void SkyDome::generateSphereMesh(unsigned int latitudeBands, unsigned int longit
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 
-    glBindVertexArray(0);
-}
+    BindVertexArray(0);
 
-void SkyDome::loadTexture(const std::string& path) {
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // Wrap around
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); // Clamp to prevent seams
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_set_flip_vertically_on_load(false); // Flip texture if necessary
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format = GL_RGB;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cerr << "Sky dome texture failed to load at path: " << path << std::endl;
-    }
-    stbi_image_free(data);
+    std::vector<float>().swap(vertices);
+    std::vector<unsigned int>().swap(indices);
 }
 
-void SkyDome::Render(Shader& shader, const glm::mat4& view, const glm::mat4& projection) {
-    glDepthFunc(GL_LEQUAL);   // Ensure sky dome is rendered behind all other objects
-    glDisable(GL_CULL_FACE);  // Disable face culling
+void SkyDome::Render(Shader& shader) {
+    SetCapability(GL_DEPTH_TEST, true);
+    SetDepthFunc(GL_LEQUAL);          // Ensure sky dome is rendered behind all other objects
+    SetDepthMask(false);              // Nothing drawn later is hidden by the dome
+    SetCapability(GL_CULL_FACE, false);  // The dome is seen from inside
 
     shader.Use();
+    if (uniformProgram != shader.ID) {
+        uniformProgram = shader.ID;
+        textureUniform = shader.GetUniform<int>("skyTexture");
+    }
 
-    // Remove translation from the view matrix
-    glm::mat4 rotView = glm::mat4(glm::mat3(view));
-    shader.setMat4("view", rotView);
-    shader.setMat4("projection", projection);
-
-    glBindVertexArray(VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    shader.setInt("skyTexture", 0); // Ensure the sampler2D uniform is set
+    BindVertexArray(VAO);
+    BindTexture(0, GL_TEXTURE_2D, textureID);
+    shader.set(textureUniform, 0); // Ensure the sampler2D uniform is set
     glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-
-    glEnable(GL_CULL_FACE);   // Re-enable face culling
-    glDepthFunc(GL_LESS);     // Restore default depth function
 }
@@ -4,20 +4,40 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 #include "Shader.h"
+#include "AssetLoader.h"
 
 class SkyDome {
 public:
+    // Builds and uploads the dome on the calling thread
     SkyDome(const std::string& texturePath);
     ~SkyDome();
-    void Render(Shader& shader, const glm::mat4& view, const glm::mat4& projection);
+
+    // Staged loading: LoadData touches no GL state and can run on a worker thread
+    SkyDome();
+    bool LoadData(const std::string& texturePath);
+    void Upload();
+
+    // Camera matrices come from the Frame uniform block
+    void Render(Shader& shader);
 
 private:
     GLuint VAO, VBO, EBO;
     GLuint textureID;
     unsigned int indexCount;
-    void loadTexture(const std::string& path);
+
+    // Staging data, released after upload
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    ImageData image;
+
+    // Uniform handles of the shader last passed to Render
+    unsigned int uniformProgram;
+    ShaderUniform<int> textureUniform;
+
     void generateSphereMesh(unsigned int latitudeBands, unsigned int longitudeBands);
+    void uploadMesh();
 };
 
 #endif 
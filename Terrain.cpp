@@ -1,143 +1,417 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 #include "Terrain.h"
+#include "GLState.h"
+#include <algorithm>
 #include <iostream>
 #include <glm/gtc/matrix_transform.hpp>
 
 // Constructor
-Terrain::Terrain(const std::string& heightmapPath, const std::string& texturePath) {
-    stbi_set_flip_vertically_on_load(true);
-    if (!loadHeightmap(heightmapPath)) {
-        std::cerr << "ERROR::TERRAIN::FAILED_TO_LOAD_HEIGHTMAP: " << heightmapPath << std::endl;
-    }
-    else {
-        std::cout << "Loaded heightmap from: " << heightmapPath << " [Width: " << width << ", Height: " << height << "]" << std::endl;
-    }
-
-    if (!loadTexture(texturePath)) {
-        std::cerr << "ERROR::TERRAIN::FAILED_TO_LOAD_TEXTURE: " << texturePath << std::endl;
-    }
-    else {
-        std::cout << "Loaded texture from: " << texturePath << std::endl;
-    }
+Terrain::Terrain(const std::string& heightmapPath, const std::string& texturePath, const TerrainOptions& options)
+    : Terrain(options) {
+    LoadHeightmap(heightmapPath);
+    LoadTextureData(texturePath);
+    BuildMesh();
+    Upload();
+}
 
-    setupMesh();
+Terrain::Terrain(const TerrainOptions& options)
+    : VAO(0), VBO(0), EBO(0), texture(0), grassTexture(0), width(0), height(0), options(options),
+    compactLayout(), indexType(GL_UNSIGNED_INT), indexSize(sizeof(unsigned int)),
+    cullStats{ 0, 0, 0 }, lodEnabled(true), lodIndexOffset(0), uniforms() {
 }
 
 // Destructor
 Terrain::~Terrain() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteTextures(1, &texture);
-    glDeleteTextures(1, &grassTexture);
+    // A terrain that was never uploaded owns no GL objects and may not have a context
+    if (VAO != 0) {
+        DeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+    if (texture != 0) {
+        DeleteTextures(1, &texture);
+    }
+    if (grassTexture != 0) {
+        DeleteTextures(1, &grassTexture);
+    }
 }
 
 // Load grass texture
 void Terrain::LoadGrassTexture(const std::string& grassTexturePath) {
-    glGenTextures(1, &grassTexture);
-    glBindTexture(GL_TEXTURE_2D, grassTexture);
+    if (LoadGrassTextureData(grassTexturePath)) {
+        Upload();
+    }
+}
 
-    int texWidth, texHeight, channels;
-    unsigned char* image = stbi_load(grassTexturePath.c_str(), &texWidth, &texHeight, &channels, 0);
-    if (!image) {
+bool Terrain::LoadGrassTextureData(const std::string& grassTexturePath) {
+    if (!LoadImageData(grassTexturePath, true, grassImage)) {
         std::cerr << "ERROR::TERRAIN::FAILED_TO_LOAD_GRASS_TEXTURE: " << grassTexturePath << std::endl;
-        return;
+        return false;
     }
+    std::cout << "Loaded grass texture from: " << grassTexturePath << std::endl;
+    return true;
+}
 
-    GLenum format = (channels == 3) ? GL_RGB : GL_RGBA;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, texWidth, texHeight, 0, format, GL_UNSIGNED_BYTE, image);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(image);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+bool Terrain::LoadTextureData(const std::string& texturePath) {
+    if (!LoadImageData(texturePath, true, textureImage)) {
+        std::cerr << "ERROR::TERRAIN::FAILED_TO_LOAD_TEXTURE: " << texturePath << std::endl;
+        return false;
+    }
+    std::cout << "Loaded texture from: " << texturePath << std::endl;
+    return true;
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    std::cout << "Loaded grass texture from: " << grassTexturePath << std::endl;
+// Upload whatever the CPU stages have produced since the last upload
+void Terrain::Upload() {
+    if (textureImage.IsValid()) {
+        DeleteTextures(1, &texture);
+        texture = CreateTexture2D(textureImage, GL_REPEAT, GL_REPEAT);
+        textureImage = ImageData();
+    }
+    if (grassImage.IsValid()) {
+        DeleteTextures(1, &grassTexture);
+        grassTexture = CreateTexture2D(grassImage, GL_REPEAT, GL_REPEAT);
+        grassImage = ImageData();
+    }
+    if (VAO == 0 && !quadtree.GetChunks().empty()) {
+        uploadMesh();
+    }
 }
 
 // Render function
-void Terrain::Render(Shader& shader) {
+void Terrain::resolveUniforms(const Shader& shader) {
+    uniforms.program = shader.ID;
+    uniforms.diffuse = shader.GetUniform<int>("material.diffuse");
+    uniforms.grass = shader.GetUniform<int>("material.grass");
+    uniforms.shininess = shader.GetUniform<float>("material.shininess");
+    uniforms.compactVertices = shader.GetUniform<bool>("compactVertices");
+    uniforms.gridWidth = shader.GetUniform<int>("gridWidth");
+    uniforms.gridHeight = shader.GetUniform<int>("gridHeight");
+    uniforms.chunkSize = shader.GetUniform<int>("chunkSize");
+    uniforms.chunksX = shader.GetUniform<int>("chunksX");
+    uniforms.heightOffset = shader.GetUniform<float>("heightOffset");
+    uniforms.heightRange = shader.GetUniform<float>("heightRange");
+    uniforms.uvScale = shader.GetUniform<float>("uvScale");
+}
+
+void Terrain::Render(Shader& shader, const glm::mat4& viewProjection, const TerrainLODView& lodView) {
     shader.Use();
+    if (uniforms.program != shader.ID) {
+        resolveUniforms(shader);
+    }
+
+    // Opaque, depth-tested and back-face culled
+    SetCapability(GL_DEPTH_TEST, true);
+    SetDepthFunc(GL_LESS);
+    SetDepthMask(true);
+    SetCapability(GL_CULL_FACE, true);
 
     // Bind the default terrain texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    shader.setInt("material.diffuse", 0);
+    BindTexture(0, GL_TEXTURE_2D, texture);
+    shader.set(uniforms.diffuse, 0);
 
     // Bind the grass texture
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, grassTexture);
-    shader.setInt("material.grass", 1);
-
-    shader.setFloat("material.shininess", 32.0f);
+    BindTexture(1, GL_TEXTURE_2D, grassTexture);
+    shader.set(uniforms.grass, 1);
+
+    shader.set(uniforms.shininess, 32.0f);
+
+    // Vertex layout used by terrain_vertex.glsl to rebuild compact vertices
+    shader.set(uniforms.compactVertices, options.vertexFormat == VERTEX_COMPACT);
+    if (options.vertexFormat == VERTEX_COMPACT) {
+        shader.set(uniforms.gridWidth, compactLayout.gridWidth);
+        shader.set(uniforms.gridHeight, compactLayout.gridHeight);
+        shader.set(uniforms.heightOffset, compactLayout.heightOffset);
+        shader.set(uniforms.heightRange, compactLayout.heightRange);
+        shader.set(uniforms.uvScale, compactLayout.uvScale);
+        shader.set(uniforms.chunkSize, compactLayout.chunkSize);
+        shader.set(uniforms.chunksX, compactLayout.chunksX);
+    }
 
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+    // Cull chunks against the view frustum
+    Frustum frustum(viewProjection);
+    visibleChunks.clear();
+    cullStats = quadtree.Cull(frustum, visibleChunks);
+
+    const std::vector<TerrainChunk>& chunks = quadtree.GetChunks();
+    drawCounts.clear();
+    drawOffsets.clear();
+    drawBaseVertices.clear();
+    BindVertexArray(VAO);
+
+    if (lodEnabled) {
+        // One stitched pattern per visible chunk, offset to the chunk's first vertex
+        lod.SelectLevels(quadtree, lodView, chunkLevels);
+        for (int chunkIndex : visibleChunks) {
+            const TerrainChunk& chunk = chunks[chunkIndex];
+            int edgeMask = lod.GetEdgeMask(quadtree, chunkLevels, chunkIndex);
+            const TerrainLOD::Pattern& pattern = lod.GetPattern(chunkIndex, chunkLevels[chunkIndex], edgeMask);
+
+            drawCounts.push_back(static_cast<GLsizei>(pattern.indexCount));
+            drawOffsets.push_back(reinterpret_cast<const void*>((lodIndexOffset + pattern.firstIndex) * indexSize));
+            drawBaseVertices.push_back(chunkBaseVertex(chunk));
+            cullStats.drawnTriangles += pattern.indexCount / 3;
+        }
+        if (!drawCounts.empty()) {
+            glMultiDrawElementsBaseVertex(GL_TRIANGLES, drawCounts.data(), indexType, drawOffsets.data(),
+                static_cast<GLsizei>(drawCounts.size()), drawBaseVertices.data());
+        }
+    }
+    else if (options.topology == TOPOLOGY_STRIPS) {
+        // Chunks of the same size share a strip pattern; rows are split by primitive restart
+        for (int chunkIndex : visibleChunks) {
+            const TerrainChunk& chunk = chunks[chunkIndex];
+            const TerrainStripTopology::Pattern& pattern = stripTopology.GetPattern(chunkIndex);
+
+            drawCounts.push_back(static_cast<GLsizei>(pattern.indexCount));
+            drawOffsets.push_back(reinterpret_cast<const void*>(static_cast<size_t>(pattern.firstIndex) * indexSize));
+            drawBaseVertices.push_back(chunkBaseVertex(chunk));
+            cullStats.drawnTriangles += static_cast<unsigned int>(chunk.quadsX * chunk.quadsZ * 2);
+        }
+        if (!drawCounts.empty()) {
+            SetCapability(GL_PRIMITIVE_RESTART, true);
+            SetPrimitiveRestartIndex(TERRAIN_RESTART_INDEX);
+            glMultiDrawElementsBaseVertex(GL_TRIANGLE_STRIP, drawCounts.data(), indexType, drawOffsets.data(),
+                static_cast<GLsizei>(drawCounts.size()), drawBaseVertices.data());
+            SetCapability(GL_PRIMITIVE_RESTART, false);
+        }
+    }
+    else {
+        // Merge chunks that are adjacent in the index buffer into a single range
+        unsigned int rangeEnd = 0;
+        for (int chunkIndex : visibleChunks) {
+            const TerrainChunk& chunk = chunks[chunkIndex];
+            if (!drawCounts.empty() && chunk.firstIndex == rangeEnd) {
+                drawCounts.back() += static_cast<GLsizei>(chunk.indexCount);
+            }
+            else {
+                drawCounts.push_back(static_cast<GLsizei>(chunk.indexCount));
+                drawOffsets.push_back(reinterpret_cast<const void*>(static_cast<size_t>(chunk.firstIndex) * indexSize));
+            }
+            rangeEnd = chunk.firstIndex + chunk.indexCount;
+            cullStats.drawnTriangles += chunk.indexCount / 3;
+        }
+        if (!drawCounts.empty()) {
+            glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), indexType, drawOffsets.data(),
+                static_cast<GLsizei>(drawCounts.size()));
+        }
+    }
+}
 
-    glBindVertexArray(0);
+// First vertex of a chunk in the vertex buffer
+GLint Terrain::chunkBaseVertex(const TerrainChunk& chunk) const {
+    if (options.topology == TOPOLOGY_STRIPS) {
+        return stripTopology.GetBaseVertex(chunk);
+    }
+    return chunk.originZ * width + chunk.originX;
 }
 
 // Load heightmap
-bool Terrain::loadHeightmap(const std::string& path) {
+bool Terrain::LoadHeightmap(const std::string& heightmapPath) {
+    // Pre-tiled heightmaps are memory-mapped; tiles are decoded as the camera or the mesh build needs them
+    if (heightmapPath.size() > 4 && heightmapPath.compare(heightmapPath.size() - 4, 4, ".hmt") == 0) {
+        std::vector<float>().swap(heightData);
+        if (!tiledHeights.Open(heightmapPath, TERRAIN_TILE_BUDGET_BYTES)) {
+            std::cerr << "ERROR::TERRAIN::FAILED_TO_LOAD_HEIGHTMAP: " << heightmapPath << std::endl;
+            width = height = 0;
+            return false;
+        }
+        width = tiledHeights.GetWidth();
+        height = tiledHeights.GetHeight();
+    }
+    else {
+        tiledHeights.Close();
+        if (!LoadHeightmapData(heightmapPath, heightData, width, height)) {
+            return false;
+        }
+    }
+    std::cout << "Loaded heightmap from: " << heightmapPath << " [Width: " << width << ", Height: " << height << "]" << std::endl;
+    return true;
+}
+
+bool Terrain::LoadHeightmapData(const std::string& path, std::vector<float>& heightData, int& width, int& height) {
+    // Row 0 is the southern edge of the terrain; set per thread so heightmaps can load on workers
+    stbi_set_flip_vertically_on_load_thread(true);
     int channels;
     unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, STBI_grey);
     if (!data) {
         std::cerr << "ERROR::TERRAIN::FAILED_TO_LOAD_HEIGHTMAP: " << path << std::endl;
+        width = height = 0;
         return false;
     }
 
     heightData.resize(width * height);
     for (int i = 0; i < width * height; ++i) {
-        heightData[i] = static_cast<float>(data[i]) / 255.0f * 20.0f; // Adjusted scaling to match shader
+        heightData[i] = static_cast<float>(data[i]) / 255.0f * TERRAIN_HEIGHT_SCALE; // Adjusted scaling to match shader
     }
     stbi_image_free(data);
     return true;
 }
 
-// Load texture
-bool Terrain::loadTexture(const std::string& texturePath) {
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+// Build all mesh data on the CPU; no GL calls, so it can run on a worker thread
+void Terrain::BuildMesh() {
+    std::vector<float> tiledStaging;
+    if (tiledHeights.IsOpen()) {
+        gatherTiledHeights(tiledStaging);
+    }
+    const std::vector<float>& heights = tiledHeights.IsOpen() ? tiledStaging : heightData;
+    if (heights.empty()) {
+        return;
+    }
 
-    int texWidth, texHeight, channels;
-    unsigned char* image = stbi_load(texturePath.c_str(), &texWidth, &texHeight, &channels, 0);
-    if (!image) {
-        std::cerr << "ERROR::TERRAIN::FAILED_TO_LOAD_TEXTURE: " << texturePath << std::endl;
-        return false;
+    // Generate vertices with positions, UVs, and placeholder normals
+    BuildVertices(heights, width, height, vertices);
+
+    // Split the grid into chunks so each one occupies a contiguous range of the index buffer
+    quadtree.Build(heights, width, height);
+
+    // The global triangle list is drawn in triangle mode and is needed for face-averaged normals
+    if (options.topology == TOPOLOGY_TRIANGLES || options.normalMode == NORMALS_FACE_AVERAGE) {
+        BuildIndices(quadtree, width, indices);
     }
 
-    GLenum format = (channels == 3) ? GL_RGB : GL_RGBA;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, texWidth, texHeight, 0, format, GL_UNSIGNED_BYTE, image);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(image);
+    // Compute normals for lighting
+    computeNormals(heights);
+
+    // Index data for the chosen topology. Strip and LOD indices are chunk-local and fit in 16 bits
+    // because strip mode stores the vertices chunk by chunk.
+    shortIndices.clear();
+    if (options.topology == TOPOLOGY_STRIPS) {
+        stripTopology.Build(quadtree);
+        lod.Build(quadtree, heights, width, stripTopology.GetRowStride());
+
+        const std::vector<uint16_t>& stripIndices = stripTopology.GetIndices();
+        const std::vector<unsigned int>& lodIndices = lod.GetIndices();
+        shortIndices.reserve(stripIndices.size() + lodIndices.size());
+        shortIndices.insert(shortIndices.end(), stripIndices.begin(), stripIndices.end());
+        lodIndexOffset = shortIndices.size();
+        for (unsigned int index : lodIndices) {
+            shortIndices.push_back(static_cast<uint16_t>(index));
+        }
+
+        // The full resolution triangle list, if any, was only needed for the normals
+        std::vector<unsigned int>().swap(indices);
+        indexType = GL_UNSIGNED_SHORT;
+        indexSize = sizeof(uint16_t);
+    }
+    else {
+        // Per-chunk level errors and stitched index patterns for the LOD mode
+        lod.Build(quadtree, heights, width, width);
+        lodIndexOffset = indices.size();
+        indices.insert(indices.end(), lod.GetIndices().begin(), lod.GetIndices().end());
+        indexType = GL_UNSIGNED_INT;
+        indexSize = sizeof(unsigned int);
+    }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Strip mode reorders the vertices chunk by chunk
+    std::vector<unsigned int> vertexRemap;
+    if (options.topology == TOPOLOGY_STRIPS) {
+        stripTopology.BuildVertexRemap(quadtree, width, vertexRemap);
+    }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return true;
+    if (options.vertexFormat == VERTEX_COMPACT) {
+        // Only height and normal are uploaded; the vertex shader derives X/Z/UV from gl_VertexID
+        EncodeCompactTerrain(vertices, width, height, TERRAIN_UV_SCALE, compactVertices, compactLayout);
+        if (options.topology == TOPOLOGY_STRIPS) {
+            std::vector<CompactTerrainVertex> rowMajor;
+            rowMajor.swap(compactVertices);
+            RemapTerrainVertices(rowMajor, vertexRemap, compactVertices);
+            compactLayout.chunkSize = quadtree.GetChunkSize();
+            compactLayout.chunksX = quadtree.GetChunksX();
+        }
+
+        // The full vertices are no longer needed on the CPU
+        std::vector<Vertex>().swap(vertices);
+    }
+    else if (options.topology == TOPOLOGY_STRIPS) {
+        std::vector<Vertex> rowMajor;
+        rowMajor.swap(vertices);
+        RemapTerrainVertices(rowMajor, vertexRemap, vertices);
+    }
+}
+
+// The uploaded mesh covers the whole map, so the build copies every tile once through the tile cache.
+// The copy is staging data that BuildMesh drops when it returns; height queries keep using the tiles.
+void Terrain::gatherTiledHeights(std::vector<float>& heights) {
+    int tileSize = tiledHeights.GetTileSize();
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesZ = (height + tileSize - 1) / tileSize;
+    heights.resize(static_cast<size_t>(width) * height);
+    for (int tileZ = 0; tileZ < tilesZ; ++tileZ) {
+        for (int tileX = 0; tileX < tilesX; ++tileX) {
+            const float* tile = tiledHeights.AcquireTile(tileX, tileZ);
+            int x0 = tileX * tileSize;
+            int z0 = tileZ * tileSize;
+            int countX = std::min(tileSize, width - x0);
+            int countZ = std::min(tileSize, height - z0);
+            for (int z = 0; z < countZ; ++z) {
+                const float* row = tile + static_cast<size_t>(z) * tileSize;
+                std::copy(row, row + countX, &heights[static_cast<size_t>(z0 + z) * width + x0]);
+            }
+        }
+    }
 }
 
-// Setup mesh
-void Terrain::setupMesh() {
+// Create the GL buffers from the data prepared by BuildMesh
+void Terrain::uploadMesh() {
+    // Generate and bind buffers
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    BindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (options.vertexFormat == VERTEX_COMPACT) {
+        glBufferData(GL_ARRAY_BUFFER, compactVertices.size() * sizeof(CompactTerrainVertex), compactVertices.data(), GL_STATIC_DRAW);
+
+        // Height
+        glVertexAttribPointer(3, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactTerrainVertex), (void*)offsetof(CompactTerrainVertex, height));
+        glEnableVertexAttribArray(3);
+        // Octahedral normal
+        glVertexAttribPointer(4, 2, GL_BYTE, GL_TRUE, sizeof(CompactTerrainVertex), (void*)offsetof(CompactTerrainVertex, normal));
+        glEnableVertexAttribArray(4);
+        std::vector<CompactTerrainVertex>().swap(compactVertices);
+    }
+    else {
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+
+        // Set vertex attribute pointers
+        // Position
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        // Normal
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        glEnableVertexAttribArray(1);
+        // TexCoords
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        glEnableVertexAttribArray(2);
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    if (indexType == GL_UNSIGNED_SHORT) {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+        std::vector<uint16_t>().swap(shortIndices);
+    }
+    else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    }
+
+    // Unbound so later element buffer binds cannot change this vertex array
+    BindVertexArray(0);
+}
+
+void Terrain::BuildVertices(const std::vector<float>& heightData, int width, int height, std::vector<Vertex>& vertices) {
     vertices.clear();
-    indices.clear();
-    float uvScale = 20.0f;
-    // Generate vertices with positions, UVs, and placeholder normals
+    vertices.reserve(static_cast<size_t>(width) * height);
     for (int z = 0; z < height; ++z) {
         for (int x = 0; x < width; ++x) {
-            float y = getHeight(x, z);
+            float y = heightData[z * width + x];
             glm::vec3 position = glm::vec3(static_cast<float>(x), y, static_cast<float>(z));
             glm::vec2 texCoords = glm::vec2(
-                (static_cast<float>(x) / (static_cast<float>(width) - 1.0f)) * uvScale,
-                (static_cast<float>(z) / (static_cast<float>(height) - 1.0f)) * uvScale
-            ); 
+                (static_cast<float>(x) / (static_cast<float>(width) - 1.0f)) * TERRAIN_UV_SCALE,
+                (static_cast<float>(z) / (static_cast<float>(height) - 1.0f)) * TERRAIN_UV_SCALE
+            );
             Vertex vertex;
             vertex.Position = position;
             vertex.TexCoords = texCoords;
@@ -145,57 +419,52 @@ void Terrain::setupMesh() {
             vertices.push_back(vertex);
         }
     }
+}
+
+void Terrain::BuildIndices(TerrainQuadtree& quadtree, int width, std::vector<unsigned int>& indices) {
+    indices.clear();
+    size_t quadCount = 0;
+    for (const TerrainChunk& chunk : quadtree.GetChunks()) {
+        quadCount += static_cast<size_t>(chunk.quadsX) * chunk.quadsZ;
+    }
+    indices.reserve(quadCount * 6);
 
     // Generate indices for two triangles per quad with corrected winding order
-    for (int z = 0; z < height - 1; ++z) {
-        for (int x = 0; x < width - 1; ++x) {
-            int topLeft = z * width + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * width + x;
-            int bottomRight = bottomLeft + 1;
-
-            // First triangle
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-
-            // Second triangle
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
+    for (TerrainChunk& chunk : quadtree.GetChunks()) {
+        chunk.firstIndex = static_cast<unsigned int>(indices.size());
+        for (int z = chunk.originZ; z < chunk.originZ + chunk.quadsZ; ++z) {
+            for (int x = chunk.originX; x < chunk.originX + chunk.quadsX; ++x) {
+                int topLeft = z * width + x;
+                int topRight = topLeft + 1;
+                int bottomLeft = (z + 1) * width + x;
+                int bottomRight = bottomLeft + 1;
+
+                // First triangle
+                indices.push_back(topLeft);
+                indices.push_back(bottomLeft);
+                indices.push_back(topRight);
+
+                // Second triangle
+                indices.push_back(topRight);
+                indices.push_back(bottomLeft);
+                indices.push_back(bottomRight);
+            }
         }
+        chunk.indexCount = static_cast<unsigned int>(indices.size()) - chunk.firstIndex;
     }
+}
 
-    // Compute normals for lighting
-    computeNormals();
-
-    // Generate and bind buffers
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    // Set vertex attribute pointers
-    // Position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    // Normal
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    glEnableVertexAttribArray(1);
-    // TexCoords
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
+// Compute normals from the height field, or by averaging adjacent triangles in the reference mode
+void Terrain::computeNormals(const std::vector<float>& heights) {
+    if (options.normalMode == NORMALS_FACE_AVERAGE) {
+        ComputeFaceNormals(vertices, indices);
+    }
+    else if (!vertices.empty()) {
+        ComputeHeightFieldNormals(heights.data(), width, height, options.normalMode, &vertices[0].Normal, sizeof(Vertex));
+    }
 }
 
-// Compute normals by averaging the normals of adjacent triangles
-void Terrain::computeNormals() {
+void Terrain::ComputeFaceNormals(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
     // Initialize all normals to zero
     for (auto& vertex : vertices) {
         vertex.Normal = glm::vec3(0.0f);
@@ -226,16 +495,33 @@ void Terrain::computeNormals() {
     }
 }
 
-// Get height at specific coordinates
-float Terrain::getHeight(int x, int z) const {
-    if (x < 0 || x >= width || z < 0 || z >= height) {
-        return 0.0f;
+// Bilinear height at world coordinates, clamped to the terrain edges
+float Terrain::GetHeightAt(float x, float z) const {
+    if (tiledHeights.IsOpen()) {
+        return SampleGridBilinear([this](int sampleX, int sampleZ) {
+            return tiledHeights.GetSample(sampleX, sampleZ);
+        }, width, height, x, z);
     }
-    return heightData[z * width + x];
+    return SampleHeightBilinear(heightData.data(), width, height, x, z);
 }
 
-float Terrain::GetHeightAt(float x, float z) const {
-    int ix = static_cast<int>(x);
-    int iz = static_cast<int>(z);
-    return getHeight(ix, iz);
+void Terrain::SampleHeights(const glm::vec2* points, float* heights, size_t count) const {
+    if (tiledHeights.IsOpen()) {
+        for (size_t i = 0; i < count; ++i) {
+            heights[i] = GetHeightAt(points[i].x, points[i].y);
+        }
+        return;
+    }
+    SampleHeightsBilinear(heightData.data(), width, height, points, heights, count);
+}
+
+void Terrain::SampleHeights(const std::vector<glm::vec2>& points, std::vector<float>& heights) const {
+    heights.resize(points.size());
+    SampleHeights(points.data(), heights.data(), points.size());
+}
+
+void Terrain::UpdateStreaming(const glm::vec3& position) {
+    if (tiledHeights.IsOpen()) {
+        tiledHeights.Update(position, TERRAIN_STREAMING_RADIUS);
+    }
 }
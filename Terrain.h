@@ -5,6 +5,15 @@
 #include <string>
 #include <vector>
 #include "Shader.h"
+#include "Frustum.h"
+#include "TerrainQuadtree.h"
+#include "TerrainLOD.h"
+#include "TerrainCompact.h"
+#include "TerrainTopology.h"
+#include "TerrainNormals.h"
+#include "TerrainSampling.h"
+#include "TiledHeightmap.h"
+#include "AssetLoader.h"
 #include <glad/glad.h>
 
 // Define a Vertex structure
@@ -14,16 +23,56 @@ struct Vertex {
     glm::vec2 TexCoords;
 };
 
+// Texture repeats across the whole terrain
+const float TERRAIN_UV_SCALE = 20.0f;
+
+// Heightmap samples map linearly onto [0, TERRAIN_HEIGHT_SCALE]
+const float TERRAIN_HEIGHT_SCALE = 20.0f;
+
+// Tiles of a .hmt heightmap kept decoded around the camera, and the memory they may use
+const float TERRAIN_STREAMING_RADIUS = 512.0f;
+const size_t TERRAIN_TILE_BUDGET_BYTES = 64 * 1024 * 1024;
+
+// GPU vertex layout of the terrain mesh
+enum Terrain_VertexFormat {
+    VERTEX_FULL,    // 32-byte Vertex with explicit position, normal and UV
+    VERTEX_COMPACT  // 4-byte CompactTerrainVertex; position and UV come from gl_VertexID
+};
+
+// Index layout of the full resolution terrain
+enum Terrain_Topology {
+    TOPOLOGY_TRIANGLES, // 32-bit global triangle list, six indices per quad
+    TOPOLOGY_STRIPS     // 16-bit chunk-local strips with primitive restart, shared by same-sized chunks
+};
+
+// Mesh generation choices, fixed when the terrain is built
+struct TerrainOptions {
+    Terrain_VertexFormat vertexFormat = VERTEX_COMPACT;
+    Terrain_Topology topology = TOPOLOGY_STRIPS;
+    Terrain_NormalMode normalMode = NORMALS_CENTRAL_DIFFERENCE;
+};
+
 class Terrain {
 public:
-    // Constructor and Destructor
-    Terrain(const std::string& heightmapPath, const std::string& texturePath);
+    // Constructor and Destructor; loads, builds and uploads everything on the calling thread
+    Terrain(const std::string& heightmapPath, const std::string& texturePath, const TerrainOptions& options = TerrainOptions());
     ~Terrain();
 
-    // Render function
-    void Render(Shader& shader);
+    // Staged loading: an empty terrain whose CPU stages can run on worker threads
+    explicit Terrain(const TerrainOptions& options);
+    // CPU stages; BuildMesh needs the heightmap, the others are independent. A .hmt heightmap stays
+    // memory-mapped and is read tile by tile instead of being decoded up front.
+    bool LoadHeightmap(const std::string& heightmapPath);
+    bool LoadTextureData(const std::string& texturePath);
+    bool LoadGrassTextureData(const std::string& grassTexturePath);
+    void BuildMesh();
+    // Creates the GL objects from the CPU stages and releases their staging data; GL thread only
+    void Upload();
+
+    // Render function; only chunks intersecting the view frustum are submitted
+    void Render(Shader& shader, const glm::mat4& viewProjection, const TerrainLODView& lodView);
 
-    // Load additional textures
+    // Load additional textures; GL thread only
     void LoadGrassTexture(const std::string& grassTexturePath);
 
     // Getter methods
@@ -31,9 +80,40 @@ public:
     int GetHeight() const { return height; }
     float GetHeightAt(float x, float z) const;
 
+    // Pages in the heightmap tiles around the camera; call once per frame. Does nothing for image heightmaps.
+    void UpdateStreaming(const glm::vec3& position);
+    // True for .hmt heightmaps, whose tile cache must not be shared between threads
+    bool IsTiled() const { return tiledHeights.IsOpen(); }
+    const TiledHeightmap& GetTiledHeightmap() const { return tiledHeights; }
+
+    // Batched bilinear heights for points given as (x, z); use for many queries at once
+    void SampleHeights(const glm::vec2* points, float* heights, size_t count) const;
+    void SampleHeights(const std::vector<glm::vec2>& points, std::vector<float>& heights) const;
+
     // Get grass texture ID
     GLuint GetGrassTexture() const { return grassTexture; }
 
+    // Chunk culling
+    const TerrainQuadtree& GetQuadtree() const { return quadtree; }
+    const TerrainCullStats& GetCullStats() const { return cullStats; }
+
+    // Level of detail; when disabled every chunk is drawn at full resolution
+    void SetLODEnabled(bool enabled) { lodEnabled = enabled; }
+    bool IsLODEnabled() const { return lodEnabled; }
+    TerrainLOD& GetLOD() { return lod; }
+
+    const TerrainOptions& GetOptions() const { return options; }
+
+    // CPU mesh generation, usable without an OpenGL context
+    // Decodes a greyscale heightmap image into world-space heights
+    static bool LoadHeightmapData(const std::string& path, std::vector<float>& heightData, int& width, int& height);
+    // One vertex per height sample, normals pointing up
+    static void BuildVertices(const std::vector<float>& heightData, int width, int height, std::vector<Vertex>& vertices);
+    // Triangle list in chunk order; fills each chunk's index range
+    static void BuildIndices(TerrainQuadtree& quadtree, int width, std::vector<unsigned int>& indices);
+    // Averages the normals of the triangles around each vertex
+    static void ComputeFaceNormals(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
 private:
     // OpenGL objects
     GLuint VAO, VBO, EBO;
@@ -42,16 +122,50 @@ private:
 
     // Heightmap and mesh data
     int width, height;
-    std::vector<float> heightData;
-    std::vector<unsigned int> indices;
-    std::vector<Vertex> vertices;
+    std::vector<float> heightData;      // Empty for tiled heightmaps
+    TiledHeightmap tiledHeights;
+    std::vector<unsigned int> indices;  // Released after upload in the strip topology
+    std::vector<Vertex> vertices;       // Released after upload in the compact format
+    std::vector<CompactTerrainVertex> compactVertices;  // Staging data, released after upload
+    std::vector<uint16_t> shortIndices;                 // Staging data, released after upload
+    ImageData textureImage;
+    ImageData grassImage;
+    TerrainOptions options;
+    CompactTerrainLayout compactLayout;
+    TerrainStripTopology stripTopology;
+    GLenum indexType;
+    size_t indexSize;
+
+    // Chunked layout and per-frame culling scratch
+    TerrainQuadtree quadtree;
+    TerrainCullStats cullStats;
+    std::vector<int> visibleChunks;
+    std::vector<GLsizei> drawCounts;
+    std::vector<const void*> drawOffsets;
+
+    // Geomipmapping patterns, stored after the full resolution indices in the same EBO
+    TerrainLOD lod;
+    bool lodEnabled;
+    size_t lodIndexOffset;
+    std::vector<int> chunkLevels;
+    std::vector<GLint> drawBaseVertices;
+
+    // Uniform handles of the shader last passed to Render
+    struct Uniforms {
+        unsigned int program;
+        ShaderUniform<int> diffuse, grass;
+        ShaderUniform<float> shininess;
+        ShaderUniform<bool> compactVertices;
+        ShaderUniform<int> gridWidth, gridHeight, chunkSize, chunksX;
+        ShaderUniform<float> heightOffset, heightRange, uvScale;
+    } uniforms;
 
     // Helper functions
-    bool loadTexture(const std::string& texturePath);
-    bool loadHeightmap(const std::string& path);
-    void setupMesh();
-    void computeNormals();
-    float getHeight(int x, int z) const;
+    void resolveUniforms(const Shader& shader);
+    void uploadMesh();
+    void gatherTiledHeights(std::vector<float>& heights);
+    void computeNormals(const std::vector<float>& heights);
+    GLint chunkBaseVertex(const TerrainChunk& chunk) const;
 };
 
 #endif
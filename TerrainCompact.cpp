@@ -0,0 +1,98 @@
+#include "TerrainCompact.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static float signNotZero(float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+glm::vec2 EncodeOctahedral(const glm::vec3& normal) {
+    // Project onto the octahedron |x| + |y| + |z| = 1, then unfold the lower half
+    glm::vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+    glm::vec2 encoded(n.x, n.z);
+    if (n.y < 0.0f) {
+        encoded = glm::vec2(
+            (1.0f - std::abs(n.z)) * signNotZero(n.x),
+            (1.0f - std::abs(n.x)) * signNotZero(n.z));
+    }
+    return encoded;
+}
+
+glm::vec3 DecodeOctahedral(const glm::vec2& encoded) {
+    glm::vec3 n(encoded.x, 1.0f - std::abs(encoded.x) - std::abs(encoded.y), encoded.y);
+    if (n.y < 0.0f) {
+        float x = n.x;
+        n.x = (1.0f - std::abs(n.z)) * signNotZero(x);
+        n.z = (1.0f - std::abs(x)) * signNotZero(n.z);
+    }
+    return glm::normalize(n);
+}
+
+static int8_t packSnorm8(float value) {
+    return static_cast<int8_t>(std::lround(glm::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+
+// Matches GL's conversion of normalized signed bytes
+static float unpackSnorm8(int8_t value) {
+    return std::max(static_cast<float>(value) / 127.0f, -1.0f);
+}
+
+void EncodeCompactTerrain(const std::vector<Vertex>& vertices, int width, int height, float uvScale,
+    std::vector<CompactTerrainVertex>& compactVertices, CompactTerrainLayout& layout) {
+    float minHeight = std::numeric_limits<float>::max();
+    float maxHeight = std::numeric_limits<float>::lowest();
+    for (const Vertex& vertex : vertices) {
+        minHeight = std::min(minHeight, vertex.Position.y);
+        maxHeight = std::max(maxHeight, vertex.Position.y);
+    }
+    if (vertices.empty()) {
+        minHeight = maxHeight = 0.0f;
+    }
+
+    layout.gridWidth = width;
+    layout.gridHeight = height;
+    layout.heightOffset = minHeight;
+    layout.heightRange = std::max(maxHeight - minHeight, 1e-6f);
+    layout.uvScale = uvScale;
+    layout.chunkSize = 0;
+    layout.chunksX = 0;
+
+    compactVertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex& vertex = vertices[i];
+        float normalizedHeight = (vertex.Position.y - layout.heightOffset) / layout.heightRange;
+        glm::vec2 octahedral = EncodeOctahedral(vertex.Normal);
+
+        CompactTerrainVertex& compact = compactVertices[i];
+        compact.height = static_cast<uint16_t>(std::lround(glm::clamp(normalizedHeight, 0.0f, 1.0f) * 65535.0f));
+        compact.normal[0] = packSnorm8(octahedral.x);
+        compact.normal[1] = packSnorm8(octahedral.y);
+    }
+}
+
+Vertex DecodeCompactTerrainVertex(const CompactTerrainVertex& compact, unsigned int vertexId, const CompactTerrainLayout& layout) {
+    int x, z;
+    if (layout.chunkSize > 0) {
+        int stride = layout.chunkSize + 1;
+        int chunk = static_cast<int>(vertexId) / (stride * stride);
+        int local = static_cast<int>(vertexId) % (stride * stride);
+        x = (chunk % layout.chunksX) * layout.chunkSize + local % stride;
+        z = (chunk / layout.chunksX) * layout.chunkSize + local / stride;
+    }
+    else {
+        x = static_cast<int>(vertexId % static_cast<unsigned int>(layout.gridWidth));
+        z = static_cast<int>(vertexId / static_cast<unsigned int>(layout.gridWidth));
+    }
+
+    Vertex vertex;
+    vertex.Position = glm::vec3(static_cast<float>(x),
+        layout.heightOffset + static_cast<float>(compact.height) / 65535.0f * layout.heightRange,
+        static_cast<float>(z));
+    vertex.Normal = DecodeOctahedral(glm::vec2(unpackSnorm8(compact.normal[0]), unpackSnorm8(compact.normal[1])));
+    vertex.TexCoords = glm::vec2(
+        static_cast<float>(x) / (static_cast<float>(layout.gridWidth) - 1.0f) * layout.uvScale,
+        static_cast<float>(z) / (static_cast<float>(layout.gridHeight) - 1.0f) * layout.uvScale);
+    return vertex;
+}
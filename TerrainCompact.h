@@ -0,0 +1,38 @@
+#ifndef TERRAIN_COMPACT_H
+#define TERRAIN_COMPACT_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct Vertex;
+
+// 4-byte terrain vertex: X, Z and texture coordinates are implied by the vertex's grid index
+struct CompactTerrainVertex {
+    uint16_t height;   // Normalized between heightOffset and heightOffset + heightRange
+    int8_t normal[2];  // Octahedral-encoded unit normal as signed normalized bytes
+};
+
+// Values needed to rebuild a full vertex from a compact one (shader uniforms)
+struct CompactTerrainLayout {
+    int gridWidth;
+    int gridHeight;
+    float heightOffset;
+    float heightRange;
+    float uvScale;
+    int chunkSize;  // Non-zero when vertices are stored chunk-major (TerrainStripTopology)
+    int chunksX;
+};
+
+// Octahedral mapping of a unit vector to [-1, 1]^2, folded around +Y so upward normals keep most precision
+glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+glm::vec3 DecodeOctahedral(const glm::vec2& encoded);
+
+// Quantizes full terrain vertices laid out as a width x height grid
+void EncodeCompactTerrain(const std::vector<Vertex>& vertices, int width, int height, float uvScale,
+    std::vector<CompactTerrainVertex>& compactVertices, CompactTerrainLayout& layout);
+
+// CPU reference of the decode in terrain_vertex.glsl
+Vertex DecodeCompactTerrainVertex(const CompactTerrainVertex& compact, unsigned int vertexId, const CompactTerrainLayout& layout);
+
+#endif
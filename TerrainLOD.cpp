@@ -0,0 +1,210 @@
+#include "TerrainLOD.h"
+#include <algorithm>
+#include <cmath>
+
+TerrainLODView MakeTerrainLODView(const glm::vec3& position, float fovYRadians, float viewportHeight) {
+    TerrainLODView view;
+    view.position = position;
+    view.projectionScale = viewportHeight / (2.0f * std::tan(fovYRadians * 0.5f));
+    return view;
+}
+
+float DistanceToAABB(const glm::vec3& point, const AABB& box) {
+    glm::vec3 closest = glm::clamp(point, box.min, box.max);
+    return glm::length(point - closest);
+}
+
+int SelectTerrainLOD(const float* levelErrors, int levelCount, float distance, float projectionScale, float pixelTolerance) {
+    // Avoid dividing by zero when the camera is inside the chunk bounds
+    float safeDistance = std::max(distance, 1e-3f);
+    int level = 0;
+    for (int i = 1; i < levelCount; ++i) {
+        float screenError = levelErrors[i] * projectionScale / safeDistance;
+        if (screenError > pixelTolerance) {
+            break;
+        }
+        level = i;
+    }
+    return level;
+}
+
+// Sample positions along one axis of a chunk: multiples of step plus the far edge
+static void levelSamples(int quads, int step, std::vector<int>& samples) {
+    samples.clear();
+    for (int i = 0; i < quads; i += step) {
+        samples.push_back(i);
+    }
+    samples.push_back(quads);
+}
+
+// Moves an edge vertex onto the coarser neighbour's sample set (multiples of coarseStep plus the far edge)
+static int snapToCoarse(int value, int quads, int coarseStep) {
+    if (value == quads) {
+        return value;
+    }
+    return (value / coarseStep) * coarseStep;
+}
+
+void BuildTerrainLODPattern(int quadsX, int quadsZ, int step, int edgeMask, int rowStride, std::vector<unsigned int>& out) {
+    std::vector<int> xs, zs;
+    levelSamples(quadsX, step, xs);
+    levelSamples(quadsZ, step, zs);
+    int coarseStep = step * 2;
+
+    auto vertexIndex = [&](int x, int z) {
+        if ((edgeMask & EDGE_WEST) && x == 0) z = snapToCoarse(z, quadsZ, coarseStep);
+        if ((edgeMask & EDGE_EAST) && x == quadsX) z = snapToCoarse(z, quadsZ, coarseStep);
+        if ((edgeMask & EDGE_NORTH) && z == 0) x = snapToCoarse(x, quadsX, coarseStep);
+        if ((edgeMask & EDGE_SOUTH) && z == quadsZ) x = snapToCoarse(x, quadsX, coarseStep);
+        return static_cast<unsigned int>(z * rowStride + x);
+    };
+    auto emit = [&](unsigned int a, unsigned int b, unsigned int c) {
+        // Snapped edges collapse some triangles to zero area
+        if (a == b || b == c || a == c) {
+            return;
+        }
+        out.push_back(a);
+        out.push_back(b);
+        out.push_back(c);
+    };
+
+    // Same winding as the full resolution mesh in Terrain::BuildMesh
+    for (size_t j = 0; j + 1 < zs.size(); ++j) {
+        for (size_t i = 0; i + 1 < xs.size(); ++i) {
+            unsigned int topLeft = vertexIndex(xs[i], zs[j]);
+            unsigned int topRight = vertexIndex(xs[i + 1], zs[j]);
+            unsigned int bottomLeft = vertexIndex(xs[i], zs[j + 1]);
+            unsigned int bottomRight = vertexIndex(xs[i + 1], zs[j + 1]);
+
+            emit(topLeft, bottomLeft, topRight);
+            emit(topRight, bottomLeft, bottomRight);
+        }
+    }
+}
+
+TerrainLOD::TerrainLOD() : PixelTolerance(TERRAIN_LOD_PIXEL_TOLERANCE), levelCount(1) {
+}
+
+void TerrainLOD::Build(const TerrainQuadtree& quadtree, const std::vector<float>& heightData, int width, int rowStride) {
+    levelErrors.clear();
+    chunkShapes.clear();
+    shapes.clear();
+    patterns.clear();
+    indices.clear();
+
+    // Coarsest level still leaves two cells along a full chunk side
+    levelCount = 1;
+    while ((1 << levelCount) < quadtree.GetChunkSize()) {
+        ++levelCount;
+    }
+
+    const std::vector<TerrainChunk>& chunks = quadtree.GetChunks();
+    levelErrors.resize(chunks.size() * levelCount, 0.0f);
+    chunkShapes.resize(chunks.size());
+
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        const TerrainChunk& chunk = chunks[c];
+
+        // Errors are made monotonic so selection can stop at the first level that is too coarse
+        float* errors = &levelErrors[c * levelCount];
+        for (int level = 1; level < levelCount; ++level) {
+            errors[level] = std::max(errors[level - 1], computeLevelError(chunk, 1 << level, heightData, width));
+        }
+
+        glm::ivec2 shape(chunk.quadsX, chunk.quadsZ);
+        auto found = std::find(shapes.begin(), shapes.end(), shape);
+        chunkShapes[c] = static_cast<int>(found - shapes.begin());
+        if (found == shapes.end()) {
+            shapes.push_back(shape);
+        }
+    }
+
+    // One pattern per chunk shape, level and edge combination
+    patterns.reserve(shapes.size() * levelCount * 16);
+    for (const glm::ivec2& shape : shapes) {
+        for (int level = 0; level < levelCount; ++level) {
+            for (int edgeMask = 0; edgeMask < 16; ++edgeMask) {
+                Pattern pattern;
+                pattern.firstIndex = static_cast<unsigned int>(indices.size());
+                BuildTerrainLODPattern(shape.x, shape.y, 1 << level, edgeMask, rowStride, indices);
+                pattern.indexCount = static_cast<unsigned int>(indices.size()) - pattern.firstIndex;
+                patterns.push_back(pattern);
+            }
+        }
+    }
+}
+
+float TerrainLOD::computeLevelError(const TerrainChunk& chunk, int step, const std::vector<float>& heightData, int width) const {
+    auto sample = [&](int x, int z) {
+        return heightData[(chunk.originZ + z) * width + chunk.originX + x];
+    };
+
+    // Largest vertical distance between the full grid and the bilinear surface through the level's samples
+    float maxError = 0.0f;
+    for (int z = 0; z <= chunk.quadsZ; ++z) {
+        int z0 = (z / step) * step;
+        int z1 = std::min(z0 + step, chunk.quadsZ);
+        float tz = (z1 > z0) ? static_cast<float>(z - z0) / static_cast<float>(z1 - z0) : 0.0f;
+        for (int x = 0; x <= chunk.quadsX; ++x) {
+            int x0 = (x / step) * step;
+            int x1 = std::min(x0 + step, chunk.quadsX);
+            float tx = (x1 > x0) ? static_cast<float>(x - x0) / static_cast<float>(x1 - x0) : 0.0f;
+
+            float top = glm::mix(sample(x0, z0), sample(x1, z0), tx);
+            float bottom = glm::mix(sample(x0, z1), sample(x1, z1), tx);
+            float approximation = glm::mix(top, bottom, tz);
+            maxError = std::max(maxError, std::abs(sample(x, z) - approximation));
+        }
+    }
+    return maxError;
+}
+
+void TerrainLOD::SelectLevels(const TerrainQuadtree& quadtree, const TerrainLODView& view, std::vector<int>& levels) const {
+    const std::vector<TerrainChunk>& chunks = quadtree.GetChunks();
+    levels.resize(chunks.size());
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        float distance = DistanceToAABB(view.position, chunks[c].bounds);
+        levels[c] = SelectTerrainLOD(GetLevelErrors(static_cast<int>(c)), levelCount, distance,
+            view.projectionScale, PixelTolerance);
+    }
+
+    // Refine chunks until no neighbour is more than one level finer; only ever lowers levels
+    const int offsets[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            int chunkX = chunks[c].originX / quadtree.GetChunkSize();
+            int chunkZ = chunks[c].originZ / quadtree.GetChunkSize();
+            for (const auto& offset : offsets) {
+                int neighbour = quadtree.GetChunkIndexAt(chunkX + offset[0], chunkZ + offset[1]);
+                if (neighbour >= 0 && levels[c] > levels[neighbour] + 1) {
+                    levels[c] = levels[neighbour] + 1;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+int TerrainLOD::GetEdgeMask(const TerrainQuadtree& quadtree, const std::vector<int>& levels, int chunkIndex) const {
+    const TerrainChunk& chunk = quadtree.GetChunks()[chunkIndex];
+    int chunkX = chunk.originX / quadtree.GetChunkSize();
+    int chunkZ = chunk.originZ / quadtree.GetChunkSize();
+    int level = levels[chunkIndex];
+
+    const int edges[4][3] = { { -1, 0, EDGE_WEST }, { 1, 0, EDGE_EAST }, { 0, -1, EDGE_NORTH }, { 0, 1, EDGE_SOUTH } };
+    int mask = 0;
+    for (const auto& edge : edges) {
+        int neighbour = quadtree.GetChunkIndexAt(chunkX + edge[0], chunkZ + edge[1]);
+        if (neighbour >= 0 && levels[neighbour] > level) {
+            mask |= edge[2];
+        }
+    }
+    return mask;
+}
+
+const TerrainLOD::Pattern& TerrainLOD::GetPattern(int chunkIndex, int level, int edgeMask) const {
+    size_t index = (static_cast<size_t>(chunkShapes[chunkIndex]) * levelCount + level) * 16 + edgeMask;
+    return patterns[index];
+}
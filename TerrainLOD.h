@@ -0,0 +1,78 @@
+#ifndef TERRAIN_LOD_H
+#define TERRAIN_LOD_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+#include "TerrainQuadtree.h"
+
+// Default screen-space error tolerance in pixels
+const float TERRAIN_LOD_PIXEL_TOLERANCE = 2.0f;
+
+// Edge bits of a chunk whose neighbour is one level coarser
+enum Terrain_Edge {
+    EDGE_WEST = 1,  // -X
+    EDGE_EAST = 2,  // +X
+    EDGE_NORTH = 4, // -Z
+    EDGE_SOUTH = 8  // +Z
+};
+
+// Camera parameters needed to pick a level of detail
+struct TerrainLODView {
+    glm::vec3 position;
+    float projectionScale; // Pixels per world unit at distance 1: viewportHeight / (2 * tan(fovY / 2))
+};
+
+TerrainLODView MakeTerrainLODView(const glm::vec3& position, float fovYRadians, float viewportHeight);
+
+// Distance from a point to the closest point of a box (0 when inside)
+float DistanceToAABB(const glm::vec3& point, const AABB& box);
+
+// Picks the coarsest level whose projected geometric error stays within the pixel tolerance.
+// levelErrors[i] is the world-space height error of level i and must be non-decreasing.
+int SelectTerrainLOD(const float* levelErrors, int levelCount, float distance, float projectionScale, float pixelTolerance);
+
+// Emits triangle indices for one chunk at the given step (1 << level). Vertices on edges listed in
+// edgeMask are snapped onto the coarser neighbour's vertices so shared edges match exactly.
+// Indices are relative to the chunk origin with the given row stride; degenerate triangles are dropped.
+void BuildTerrainLODPattern(int quadsX, int quadsZ, int step, int edgeMask, int rowStride, std::vector<unsigned int>& out);
+
+// Geomipmapping data for a chunked terrain: per-chunk level errors and stitched index patterns
+// shared by every chunk of the same size. Pure CPU so it can be tested and benchmarked headlessly.
+class TerrainLOD {
+public:
+    struct Pattern {
+        unsigned int firstIndex;
+        unsigned int indexCount;
+    };
+
+    TerrainLOD();
+
+    // Pattern indices are relative to the chunk origin with the given vertex row stride
+    void Build(const TerrainQuadtree& quadtree, const std::vector<float>& heightData, int width, int rowStride);
+
+    // Picks a level for every chunk, then limits neighbouring chunks to one level apart
+    void SelectLevels(const TerrainQuadtree& quadtree, const TerrainLODView& view, std::vector<int>& levels) const;
+
+    // Bitmask of Terrain_Edge values where the neighbouring chunk is coarser
+    int GetEdgeMask(const TerrainQuadtree& quadtree, const std::vector<int>& levels, int chunkIndex) const;
+
+    const Pattern& GetPattern(int chunkIndex, int level, int edgeMask) const;
+    const std::vector<unsigned int>& GetIndices() const { return indices; }
+    int GetLevelCount() const { return levelCount; }
+    const float* GetLevelErrors(int chunkIndex) const { return &levelErrors[static_cast<size_t>(chunkIndex) * levelCount]; }
+
+    float PixelTolerance;
+
+private:
+    int levelCount;
+    std::vector<float> levelErrors;     // chunkCount x levelCount
+    std::vector<int> chunkShapes;       // Shape index per chunk
+    std::vector<glm::ivec2> shapes;     // Distinct (quadsX, quadsZ) chunk sizes
+    std::vector<Pattern> patterns;      // shape x level x 16 edge masks
+    std::vector<unsigned int> indices;  // All patterns back to back
+
+    float computeLevelError(const TerrainChunk& chunk, int step, const std::vector<float>& heightData, int width) const;
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "TerrainNormals.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERRAIN_NORMALS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+struct NormalJob {
+    const float* heights;
+    int width;
+    int height;
+    Terrain_NormalMode mode;
+    unsigned char* normals;
+    size_t normalStride;
+};
+
+inline void storeNormal(const NormalJob& job, int x, int z, float dx, float dz) {
+    // n = normalize(-dh/dx, 1, -dh/dz)
+    float inverseLength = 1.0f / std::sqrt(dx * dx + dz * dz + 1.0f);
+    glm::vec3* normal = reinterpret_cast<glm::vec3*>(job.normals + (static_cast<size_t>(z) * job.width + x) * job.normalStride);
+    *normal = glm::vec3(-dx * inverseLength, inverseLength, -dz * inverseLength);
+}
+
+// Scalar path with clamped neighbours; handles borders and row tails
+void normalAt(const NormalJob& job, int x, int z) {
+    int x0 = std::max(x - 1, 0), x1 = std::min(x + 1, job.width - 1);
+    int z0 = std::max(z - 1, 0), z1 = std::min(z + 1, job.height - 1);
+    auto h = [&](int sx, int sz) { return job.heights[static_cast<size_t>(sz) * job.width + sx]; };
+
+    // One-sided differences at the border span a single cell
+    float spanX = static_cast<float>(std::max(x1 - x0, 1));
+    float spanZ = static_cast<float>(std::max(z1 - z0, 1));
+    float dx, dz;
+    if (job.mode == NORMALS_SOBEL) {
+        dx = ((h(x1, z0) + 2.0f * h(x1, z) + h(x1, z1)) - (h(x0, z0) + 2.0f * h(x0, z) + h(x0, z1))) / (4.0f * spanX);
+        dz = ((h(x0, z1) + 2.0f * h(x, z1) + h(x1, z1)) - (h(x0, z0) + 2.0f * h(x, z0) + h(x1, z0))) / (4.0f * spanZ);
+    }
+    else {
+        dx = (h(x1, z) - h(x0, z)) / spanX;
+        dz = (h(x, z1) - h(x, z0)) / spanZ;
+    }
+    storeNormal(job, x, z, dx, dz);
+}
+
+void processRows(const NormalJob& job, int rowBegin, int rowEnd) {
+    for (int z = rowBegin; z < rowEnd; ++z) {
+        bool interiorRow = z > 0 && z < job.height - 1;
+        int x = 0;
+        if (interiorRow && job.width > 2) {
+            normalAt(job, 0, z);
+            x = 1;
+#ifdef TERRAIN_NORMALS_SSE2
+            const float* above = job.heights + static_cast<size_t>(z - 1) * job.width;
+            const float* row = job.heights + static_cast<size_t>(z) * job.width;
+            const float* below = job.heights + static_cast<size_t>(z + 1) * job.width;
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 two = _mm_set1_ps(2.0f);
+            const __m128 eighth = _mm_set1_ps(0.125f);
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 signMask = _mm_set1_ps(-0.0f);
+
+            // Four interior samples per iteration; x + 4 must stay inside the row
+            for (; x + 4 < job.width; x += 4) {
+                __m128 dx, dz;
+                if (job.mode == NORMALS_SOBEL) {
+                    __m128 left = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(above + x - 1), _mm_loadu_ps(below + x - 1)),
+                        _mm_mul_ps(two, _mm_loadu_ps(row + x - 1)));
+                    __m128 right = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(above + x + 1), _mm_loadu_ps(below + x + 1)),
+                        _mm_mul_ps(two, _mm_loadu_ps(row + x + 1)));
+                    __m128 top = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(above + x - 1), _mm_loadu_ps(above + x + 1)),
+                        _mm_mul_ps(two, _mm_loadu_ps(above + x)));
+                    __m128 bottom = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(below + x - 1), _mm_loadu_ps(below + x + 1)),
+                        _mm_mul_ps(two, _mm_loadu_ps(below + x)));
+                    dx = _mm_mul_ps(_mm_sub_ps(right, left), eighth);
+                    dz = _mm_mul_ps(_mm_sub_ps(bottom, top), eighth);
+                }
+                else {
+                    dx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(row + x + 1), _mm_loadu_ps(row + x - 1)), half);
+                    dz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(below + x), _mm_loadu_ps(above + x)), half);
+                }
+
+                __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)), one);
+                __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+                float nx[4], ny[4], nz[4];
+                _mm_storeu_ps(nx, _mm_mul_ps(_mm_xor_ps(dx, signMask), inverseLength));
+                _mm_storeu_ps(ny, inverseLength);
+                _mm_storeu_ps(nz, _mm_mul_ps(_mm_xor_ps(dz, signMask), inverseLength));
+
+                // The destination is usually an interleaved vertex array, so scatter the lanes
+                unsigned char* out = job.normals + (static_cast<size_t>(z) * job.width + x) * job.normalStride;
+                for (int lane = 0; lane < 4; ++lane) {
+                    *reinterpret_cast<glm::vec3*>(out + lane * job.normalStride) = glm::vec3(nx[lane], ny[lane], nz[lane]);
+                }
+            }
+#endif
+        }
+        for (; x < job.width; ++x) {
+            normalAt(job, x, z);
+        }
+    }
+}
+
+} // namespace
+
+void ComputeHeightFieldNormals(const float* heights, int width, int height, Terrain_NormalMode mode,
+    glm::vec3* normals, size_t normalStride, int threadCount) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    NormalJob job;
+    job.heights = heights;
+    job.width = width;
+    job.height = height;
+    job.mode = (mode == NORMALS_SOBEL) ? NORMALS_SOBEL : NORMALS_CENTRAL_DIFFERENCE;
+    job.normals = reinterpret_cast<unsigned char*>(normals);
+    job.normalStride = normalStride;
+
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    threadCount = std::min(threadCount, height);
+
+    // Each thread writes a contiguous band of rows, so no synchronization is needed
+    std::vector<std::thread> workers;
+    int rowsPerThread = (height + threadCount - 1) / threadCount;
+    for (int t = 1; t < threadCount; ++t) {
+        int rowBegin = t * rowsPerThread;
+        int rowEnd = std::min(rowBegin + rowsPerThread, height);
+        if (rowBegin < rowEnd) {
+            workers.emplace_back(processRows, std::cref(job), rowBegin, rowEnd);
+        }
+    }
+    processRows(job, 0, std::min(rowsPerThread, height));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef TERRAIN_NORMALS_H
+#define TERRAIN_NORMALS_H
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// How terrain vertex normals are generated
+enum Terrain_NormalMode {
+    NORMALS_FACE_AVERAGE,       // Reference: accumulate triangle normals through the index buffer
+    NORMALS_CENTRAL_DIFFERENCE, // Gradient from the four direct neighbours
+    NORMALS_SOBEL               // Gradient from the 3x3 Sobel operator, slightly smoother
+};
+
+// Computes unit normals straight from a width x height grid of heights (grid spacing 1).
+// Rows are split across threadCount threads (0 = hardware concurrency) and vectorized with
+// SSE2 where available. Normals are written to normals[i * normalStride bytes], so they can
+// go directly into an interleaved vertex array. FACE_AVERAGE is not supported here; use
+// Terrain::ComputeFaceNormals for it.
+void ComputeHeightFieldNormals(const float* heights, int width, int height, Terrain_NormalMode mode,
+    glm::vec3* normals, size_t normalStride = sizeof(glm::vec3), int threadCount = 0);
+
+#endif
@@ -0,0 +1,124 @@
+#include "TerrainQuadtree.h"
+#include <algorithm>
+#include <limits>
+
+TerrainQuadtree::TerrainQuadtree() : chunkSize(TERRAIN_CHUNK_SIZE), chunksX(0), chunksZ(0), root(-1) {
+}
+
+void TerrainQuadtree::Build(const std::vector<float>& heightData, int width, int height, int chunkSize) {
+    nodes.clear();
+    chunks.clear();
+    gridToChunk.clear();
+    chunksX = chunksZ = 0;
+    root = -1;
+    this->chunkSize = std::max(1, chunkSize);
+
+    if (width < 2 || height < 2) {
+        return;
+    }
+
+    // Chunks share their border vertices, so they tile the (width - 1) x (height - 1) quads
+    chunksX = (width - 2) / this->chunkSize + 1;
+    chunksZ = (height - 2) / this->chunkSize + 1;
+    chunks.reserve(static_cast<size_t>(chunksX) * chunksZ);
+    gridToChunk.assign(static_cast<size_t>(chunksX) * chunksZ, -1);
+    root = buildNode(heightData, width, height, 0, 0, chunksX, chunksZ);
+}
+
+int TerrainQuadtree::buildNode(const std::vector<float>& heightData, int width, int height,
+    int chunkX0, int chunkZ0, int chunkX1, int chunkZ1) {
+    int nodeIndex = static_cast<int>(nodes.size());
+    nodes.push_back(Node());
+    Node node;
+    node.children[0] = node.children[1] = node.children[2] = node.children[3] = -1;
+    node.firstChunk = static_cast<int>(chunks.size());
+
+    if (chunkX1 - chunkX0 == 1 && chunkZ1 - chunkZ0 == 1) {
+        // Leaf: compute the chunk bounds from its height samples
+        TerrainChunk chunk;
+        chunk.originX = chunkX0 * chunkSize;
+        chunk.originZ = chunkZ0 * chunkSize;
+        chunk.quadsX = std::min(chunkSize, width - 1 - chunk.originX);
+        chunk.quadsZ = std::min(chunkSize, height - 1 - chunk.originZ);
+        chunk.firstIndex = 0;
+        chunk.indexCount = 0;
+
+        float minY = std::numeric_limits<float>::max();
+        float maxY = std::numeric_limits<float>::lowest();
+        for (int z = chunk.originZ; z <= chunk.originZ + chunk.quadsZ; ++z) {
+            for (int x = chunk.originX; x <= chunk.originX + chunk.quadsX; ++x) {
+                float y = heightData[z * width + x];
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
+        }
+        chunk.bounds.min = glm::vec3(static_cast<float>(chunk.originX), minY, static_cast<float>(chunk.originZ));
+        chunk.bounds.max = glm::vec3(static_cast<float>(chunk.originX + chunk.quadsX), maxY,
+            static_cast<float>(chunk.originZ + chunk.quadsZ));
+
+        node.bounds = chunk.bounds;
+        gridToChunk[chunkZ0 * chunksX + chunkX0] = static_cast<int>(chunks.size());
+        chunks.push_back(chunk);
+    }
+    else {
+        // Split the chunk rectangle into up to four quadrants
+        int midX = chunkX0 + (chunkX1 - chunkX0 + 1) / 2;
+        int midZ = chunkZ0 + (chunkZ1 - chunkZ0 + 1) / 2;
+        int ranges[4][4] = {
+            { chunkX0, chunkZ0, midX, midZ },
+            { midX, chunkZ0, chunkX1, midZ },
+            { chunkX0, midZ, midX, chunkZ1 },
+            { midX, midZ, chunkX1, chunkZ1 }
+        };
+
+        node.bounds.min = glm::vec3(std::numeric_limits<float>::max());
+        node.bounds.max = glm::vec3(std::numeric_limits<float>::lowest());
+        for (int i = 0; i < 4; ++i) {
+            if (ranges[i][0] >= ranges[i][2] || ranges[i][1] >= ranges[i][3]) {
+                continue;
+            }
+            int child = buildNode(heightData, width, height, ranges[i][0], ranges[i][1], ranges[i][2], ranges[i][3]);
+            node.children[i] = child;
+            node.bounds.min = glm::min(node.bounds.min, nodes[child].bounds.min);
+            node.bounds.max = glm::max(node.bounds.max, nodes[child].bounds.max);
+        }
+    }
+
+    node.chunkCount = static_cast<int>(chunks.size()) - node.firstChunk;
+    nodes[nodeIndex] = node;
+    return nodeIndex;
+}
+
+TerrainCullStats TerrainQuadtree::Cull(const Frustum& frustum, std::vector<int>& visibleChunks) const {
+    size_t before = visibleChunks.size();
+    if (root >= 0) {
+        cullNode(root, frustum, visibleChunks);
+    }
+
+    TerrainCullStats stats;
+    stats.drawnChunks = static_cast<int>(visibleChunks.size() - before);
+    stats.culledChunks = GetChunkCount() - stats.drawnChunks;
+    stats.drawnTriangles = 0;
+    return stats;
+}
+
+void TerrainQuadtree::cullNode(int nodeIndex, const Frustum& frustum, std::vector<int>& visibleChunks) const {
+    const Node& node = nodes[nodeIndex];
+    Frustum_Containment containment = frustum.Classify(node.bounds);
+
+    if (containment == OUTSIDE) {
+        return;
+    }
+    if (containment == INSIDE || node.chunkCount == 1) {
+        // The whole subtree is visible; no need to test the children
+        for (int i = 0; i < node.chunkCount; ++i) {
+            visibleChunks.push_back(node.firstChunk + i);
+        }
+        return;
+    }
+    for (int child : node.children) {
+        if (child >= 0) {
+            cullNode(child, frustum, visibleChunks);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef TERRAIN_QUADTREE_H
+#define TERRAIN_QUADTREE_H
+
+#include <vector>
+#include "Frustum.h"
+
+// Number of quads along each side of a terrain chunk
+const int TERRAIN_CHUNK_SIZE = 64;
+
+// A rectangular block of the heightmap grid that is culled and drawn as a unit
+struct TerrainChunk {
+    int originX, originZ;   // Grid coordinates of the chunk's first vertex
+    int quadsX, quadsZ;     // Number of quads covered (smaller at the far map edges)
+    AABB bounds;
+
+    // Range in the terrain index buffer, filled in by Terrain::BuildIndices
+    unsigned int firstIndex;
+    unsigned int indexCount;
+};
+
+// Per-frame culling result
+struct TerrainCullStats {
+    int drawnChunks;
+    int culledChunks;
+    unsigned int drawnTriangles;
+};
+
+// Quadtree over the terrain chunks. It is pure CPU data so culling can run without a GL context.
+class TerrainQuadtree {
+public:
+    TerrainQuadtree();
+
+    // Splits a width x height grid of samples into chunks and builds the tree bottom-up
+    void Build(const std::vector<float>& heightData, int width, int height, int chunkSize = TERRAIN_CHUNK_SIZE);
+
+    // Appends the indices of all chunks intersecting the frustum, in chunk order
+    TerrainCullStats Cull(const Frustum& frustum, std::vector<int>& visibleChunks) const;
+
+    std::vector<TerrainChunk>& GetChunks() { return chunks; }
+    const std::vector<TerrainChunk>& GetChunks() const { return chunks; }
+    int GetChunkCount() const { return static_cast<int>(chunks.size()); }
+    int GetChunkSize() const { return chunkSize; }
+
+    // Chunk grid dimensions and lookup by chunk grid coordinates (-1 outside the grid)
+    int GetChunksX() const { return chunksX; }
+    int GetChunksZ() const { return chunksZ; }
+    int GetChunkIndexAt(int chunkX, int chunkZ) const {
+        if (chunkX < 0 || chunkX >= chunksX || chunkZ < 0 || chunkZ >= chunksZ) {
+            return -1;
+        }
+        return gridToChunk[chunkZ * chunksX + chunkX];
+    }
+
+private:
+    struct Node {
+        AABB bounds;
+        int children[4];    // -1 for missing children
+        int firstChunk;     // Chunks of a subtree are contiguous in the chunk array
+        int chunkCount;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<TerrainChunk> chunks;
+    std::vector<int> gridToChunk;
+    int chunkSize;
+    int chunksX, chunksZ;
+    int root;
+
+    int buildNode(const std::vector<float>& heightData, int width, int height,
+        int chunkX0, int chunkZ0, int chunkX1, int chunkZ1);
+    void cullNode(int nodeIndex, const Frustum& frustum, std::vector<int>& visibleChunks) const;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "TerrainSampling.h"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#define TERRAIN_SAMPLING_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERRAIN_SAMPLING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+float SampleHeightBilinear(const float* heights, int width, int height, float x, float z) {
+    return SampleGridBilinear([heights, width](int sampleX, int sampleZ) {
+        return heights[static_cast<size_t>(sampleZ) * width + sampleX];
+    }, width, height, x, z);
+}
+
+void SampleHeightsBilinear(const float* heights, int width, int height, const glm::vec2* points, float* out, size_t count) {
+    if (width <= 0 || height <= 0) {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+    size_t i = 0;
+
+#if defined(TERRAIN_SAMPLING_AVX2)
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 maxX = _mm256_set1_ps(static_cast<float>(width - 1));
+    const __m256 maxZ = _mm256_set1_ps(static_cast<float>(height - 1));
+    const __m256i rowStride = _mm256_set1_epi32(width);
+    // De-interleave (x, z) pairs: gather even and odd floats
+    const __m256i evenLanes = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+
+    for (; i + 8 <= count; i += 8) {
+        const float* base = &points[i].x;
+        __m256 x = _mm256_i32gather_ps(base, evenLanes, 4);
+        __m256 z = _mm256_i32gather_ps(base + 1, evenLanes, 4);
+        // x * 0 is NaN exactly when x is not finite. max_ps returns its second operand for a NaN, so
+        // those lanes sample the first corner and are zeroed at the end.
+        __m256 finite = _mm256_cmp_ps(_mm256_mul_ps(x, zero), _mm256_mul_ps(z, zero), _CMP_ORD_Q);
+        x = _mm256_min_ps(_mm256_max_ps(x, zero), maxX);
+        z = _mm256_min_ps(_mm256_max_ps(z, zero), maxZ);
+
+        __m256 x0f = _mm256_floor_ps(x);
+        __m256 z0f = _mm256_floor_ps(z);
+        __m256 fx = _mm256_sub_ps(x, x0f);
+        __m256 fz = _mm256_sub_ps(z, z0f);
+        __m256i x0 = _mm256_cvttps_epi32(x0f);
+        __m256i x1 = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_add_ps(x0f, one), maxX));
+        __m256i row0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(z0f), rowStride);
+        __m256i row1 = _mm256_mullo_epi32(_mm256_cvttps_epi32(_mm256_min_ps(_mm256_add_ps(z0f, one), maxZ)), rowStride);
+
+        __m256 h00 = _mm256_i32gather_ps(heights, _mm256_add_epi32(row0, x0), 4);
+        __m256 h10 = _mm256_i32gather_ps(heights, _mm256_add_epi32(row0, x1), 4);
+        __m256 h01 = _mm256_i32gather_ps(heights, _mm256_add_epi32(row1, x0), 4);
+        __m256 h11 = _mm256_i32gather_ps(heights, _mm256_add_epi32(row1, x1), 4);
+
+        __m256 top = _mm256_add_ps(h00, _mm256_mul_ps(_mm256_sub_ps(h10, h00), fx));
+        __m256 bottom = _mm256_add_ps(h01, _mm256_mul_ps(_mm256_sub_ps(h11, h01), fx));
+        __m256 result = _mm256_add_ps(top, _mm256_mul_ps(_mm256_sub_ps(bottom, top), fz));
+        _mm256_storeu_ps(out + i, _mm256_and_ps(result, finite));
+    }
+#elif defined(TERRAIN_SAMPLING_SSE2)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maxX = _mm_set1_ps(static_cast<float>(width - 1));
+    const __m128 maxZ = _mm_set1_ps(static_cast<float>(height - 1));
+
+    for (; i + 4 <= count; i += 4) {
+        // Two (x, z, x, z) loads shuffled into x and z lanes
+        __m128 a = _mm_loadu_ps(&points[i].x);
+        __m128 b = _mm_loadu_ps(&points[i + 2].x);
+        __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 z = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        // As in the AVX2 loop: non-finite lanes clamp to 0 and are zeroed at the end
+        __m128 finite = _mm_cmpord_ps(_mm_mul_ps(x, zero), _mm_mul_ps(z, zero));
+        x = _mm_min_ps(_mm_max_ps(x, zero), maxX);
+        z = _mm_min_ps(_mm_max_ps(z, zero), maxZ);
+
+        __m128i x0 = _mm_cvttps_epi32(x);
+        __m128i z0 = _mm_cvttps_epi32(z);
+        __m128 fx = _mm_sub_ps(x, _mm_cvtepi32_ps(x0));
+        __m128 fz = _mm_sub_ps(z, _mm_cvtepi32_ps(z0));
+
+        // SSE2 has no gather; fetch the four corners per lane with scalar loads
+        alignas(16) int xs[4], zs[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(xs), x0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(zs), z0);
+        alignas(16) float h00[4], h10[4], h01[4], h11[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            int x1 = std::min(xs[lane] + 1, width - 1);
+            int z1 = std::min(zs[lane] + 1, height - 1);
+            const float* row0 = heights + static_cast<size_t>(zs[lane]) * width;
+            const float* row1 = heights + static_cast<size_t>(z1) * width;
+            h00[lane] = row0[xs[lane]];
+            h10[lane] = row0[x1];
+            h01[lane] = row1[xs[lane]];
+            h11[lane] = row1[x1];
+        }
+
+        __m128 c00 = _mm_load_ps(h00), c10 = _mm_load_ps(h10), c01 = _mm_load_ps(h01), c11 = _mm_load_ps(h11);
+        __m128 top = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c10, c00), fx));
+        __m128 bottom = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(c11, c01), fx));
+        __m128 result = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fz));
+        _mm_storeu_ps(out + i, _mm_and_ps(result, finite));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = SampleHeightBilinear(heights, width, height, points[i].x, points[i].y);
+    }
+}
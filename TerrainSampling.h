@@ -0,0 +1,43 @@
+#ifndef TERRAIN_SAMPLING_H
+#define TERRAIN_SAMPLING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// Bilinear height at world (x, z) on a width x height grid with spacing 1.
+// Coordinates are clamped to the grid, so there are no bounds branches; NaN or infinite ones give 0.
+float SampleHeightBilinear(const float* heights, int width, int height, float x, float z);
+
+// SampleHeightBilinear for grids that are not one array; fetch(x, z) returns the sample at integer
+// grid coordinates inside the grid
+template <typename Fetch>
+float SampleGridBilinear(const Fetch& fetch, int width, int height, float x, float z) {
+    // A NaN would pass through the clamps into the integer casts
+    if (width <= 0 || height <= 0 || !std::isfinite(x) || !std::isfinite(z)) {
+        return 0.0f;
+    }
+    x = std::min(std::max(x, 0.0f), static_cast<float>(width - 1));
+    z = std::min(std::max(z, 0.0f), static_cast<float>(height - 1));
+
+    // Truncation is floor here because the coordinates are non-negative
+    int x0 = static_cast<int>(x);
+    int z0 = static_cast<int>(z);
+    int x1 = std::min(x0 + 1, width - 1);
+    int z1 = std::min(z0 + 1, height - 1);
+    float fx = x - static_cast<float>(x0);
+    float fz = z - static_cast<float>(z0);
+
+    float h00 = fetch(x0, z0), h10 = fetch(x1, z0);
+    float h01 = fetch(x0, z1), h11 = fetch(x1, z1);
+    float top = h00 + (h10 - h00) * fx;
+    float bottom = h01 + (h11 - h01) * fx;
+    return top + (bottom - top) * fz;
+}
+
+// Batched version of SampleHeightBilinear for points given as (x, z). Uses AVX2 gathers when
+// compiled for AVX2, otherwise SSE2 for the coordinate math with scalar loads.
+void SampleHeightsBilinear(const float* heights, int width, int height, const glm::vec2* points, float* out, size_t count);
+
+#endif
@@ -0,0 +1,82 @@
+#include "TerrainTopology.h"
+#include <algorithm>
+
+size_t TerrainStripIndexCount(int quadsX, int quadsZ) {
+    if (quadsX <= 0 || quadsZ <= 0) {
+        return 0;
+    }
+    // Two indices per column per row, plus a restart between rows
+    return static_cast<size_t>(quadsZ) * 2 * (quadsX + 1) + (quadsZ - 1);
+}
+
+void BuildTerrainStripPattern(int quadsX, int quadsZ, int rowStride, std::vector<uint16_t>& out) {
+    for (int z = 0; z < quadsZ; ++z) {
+        if (z > 0) {
+            out.push_back(TERRAIN_RESTART_INDEX);
+        }
+        // Alternating top/bottom vertices give (TL, BL, TR), (TR, BL, BR) for each quad
+        for (int x = 0; x <= quadsX; ++x) {
+            out.push_back(static_cast<uint16_t>(z * rowStride + x));
+            out.push_back(static_cast<uint16_t>((z + 1) * rowStride + x));
+        }
+    }
+}
+
+TerrainStripTopology::TerrainStripTopology() : chunkSize(TERRAIN_CHUNK_SIZE), chunksX(0) {
+}
+
+void TerrainStripTopology::Build(const TerrainQuadtree& quadtree) {
+    chunkSize = quadtree.GetChunkSize();
+    chunksX = quadtree.GetChunksX();
+    chunkShapes.clear();
+    patterns.clear();
+    indices.clear();
+
+    // Collect the distinct chunk sizes (at most four: interior, last column, last row, corner)
+    const std::vector<TerrainChunk>& chunks = quadtree.GetChunks();
+    std::vector<std::pair<int, int>> shapes;
+    chunkShapes.resize(chunks.size());
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        std::pair<int, int> shape(chunks[c].quadsX, chunks[c].quadsZ);
+        auto found = std::find(shapes.begin(), shapes.end(), shape);
+        chunkShapes[c] = static_cast<int>(found - shapes.begin());
+        if (found == shapes.end()) {
+            shapes.push_back(shape);
+        }
+    }
+
+    size_t total = 0;
+    for (const auto& shape : shapes) {
+        total += TerrainStripIndexCount(shape.first, shape.second);
+    }
+    indices.reserve(total);
+
+    for (const auto& shape : shapes) {
+        Pattern pattern;
+        pattern.firstIndex = static_cast<unsigned int>(indices.size());
+        BuildTerrainStripPattern(shape.first, shape.second, GetRowStride(), indices);
+        pattern.indexCount = static_cast<unsigned int>(indices.size()) - pattern.firstIndex;
+        patterns.push_back(pattern);
+    }
+}
+
+int TerrainStripTopology::GetBaseVertex(const TerrainChunk& chunk) const {
+    int chunkX = chunk.originX / chunkSize;
+    int chunkZ = chunk.originZ / chunkSize;
+    return (chunkZ * chunksX + chunkX) * GetVerticesPerChunk();
+}
+
+void TerrainStripTopology::BuildVertexRemap(const TerrainQuadtree& quadtree, int width, std::vector<unsigned int>& remap) const {
+    int stride = GetRowStride();
+    remap.assign(static_cast<size_t>(quadtree.GetChunksX()) * quadtree.GetChunksZ() * GetVerticesPerChunk(), 0);
+    for (const TerrainChunk& chunk : quadtree.GetChunks()) {
+        size_t base = static_cast<size_t>(GetBaseVertex(chunk));
+        for (int z = 0; z < stride; ++z) {
+            for (int x = 0; x < stride; ++x) {
+                int sourceX = chunk.originX + std::min(x, chunk.quadsX);
+                int sourceZ = chunk.originZ + std::min(z, chunk.quadsZ);
+                remap[base + z * stride + x] = static_cast<unsigned int>(sourceZ * width + sourceX);
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef TERRAIN_TOPOLOGY_H
+#define TERRAIN_TOPOLOGY_H
+
+#include <cstdint>
+#include <vector>
+#include "TerrainQuadtree.h"
+
+// Primitive restart index separating the strips of consecutive quad rows
+const uint16_t TERRAIN_RESTART_INDEX = 0xFFFF;
+
+// Emits one triangle strip per row of quads, separated by TERRAIN_RESTART_INDEX. Triangles have the
+// same winding and diagonal as the triangle list in Terrain::BuildIndices. Indices are chunk-local.
+void BuildTerrainStripPattern(int quadsX, int quadsZ, int rowStride, std::vector<uint16_t>& out);
+
+// Number of indices BuildTerrainStripPattern emits, used to reserve the buffer up front
+size_t TerrainStripIndexCount(int quadsX, int quadsZ);
+
+// Chunk-local strip topology. Vertices are stored chunk-major, every chunk padded to
+// (chunkSize + 1)^2 vertices in chunk grid order, so indices fit in 16 bits and all chunks
+// of the same size share one index pattern.
+class TerrainStripTopology {
+public:
+    struct Pattern {
+        unsigned int firstIndex;
+        unsigned int indexCount;
+    };
+
+    TerrainStripTopology();
+
+    void Build(const TerrainQuadtree& quadtree);
+
+    // Row-major source vertex for every chunk-major vertex slot; padding repeats the chunk's last vertex
+    void BuildVertexRemap(const TerrainQuadtree& quadtree, int width, std::vector<unsigned int>& remap) const;
+
+    const Pattern& GetPattern(int chunkIndex) const { return patterns[chunkShapes[chunkIndex]]; }
+    int GetBaseVertex(const TerrainChunk& chunk) const;
+    int GetVerticesPerChunk() const { return (chunkSize + 1) * (chunkSize + 1); }
+    int GetRowStride() const { return chunkSize + 1; }
+    const std::vector<uint16_t>& GetIndices() const { return indices; }
+
+private:
+    int chunkSize;
+    int chunksX;
+    std::vector<int> chunkShapes;   // Pattern index per chunk
+    std::vector<Pattern> patterns;  // One per distinct chunk size
+    std::vector<uint16_t> indices;
+};
+
+// Gathers vertices into chunk-major order using a remap from TerrainStripTopology::BuildVertexRemap
+template <typename VertexType>
+void RemapTerrainVertices(const std::vector<VertexType>& source, const std::vector<unsigned int>& remap, std::vector<VertexType>& out) {
+    out.resize(remap.size());
+    for (size_t i = 0; i < remap.size(); ++i) {
+        out[i] = source[remap[i]];
+    }
+}
+
+#endif
@@ -0,0 +1,305 @@
+#include "TextureCompression.h"
+#include "FileUtils.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+// stb_dxt uses memcpy without including <string.h> itself
+#define STB_DXT_IMPLEMENTATION
+#include <stb/stb_dxt.h>
+#include <stb/stb_image.h>
+
+namespace {
+
+bool enabled = false;
+
+size_t blockSizeOf(GLenum format) {
+    return format == COMPRESSED_RGB_S3TC_DXT1 ? 8 : 16;
+}
+
+size_t levelSize(int width, int height, size_t blockSize) {
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+}
+
+// Halves an RGBA image with a 2x2 box filter, like glGenerateMipmap; odd edges repeat the last texel
+void downsample(const std::vector<unsigned char>& source, int width, int height,
+    std::vector<unsigned char>& target, int& targetWidth, int& targetHeight) {
+    targetWidth = std::max(width / 2, 1);
+    targetHeight = std::max(height / 2, 1);
+    target.resize(static_cast<size_t>(targetWidth) * targetHeight * 4);
+    for (int y = 0; y < targetHeight; ++y) {
+        int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < targetWidth; ++x) {
+            int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < 4; ++c) {
+                int sum = source[(static_cast<size_t>(y0) * width + x0) * 4 + c] + source[(static_cast<size_t>(y0) * width + x1) * 4 + c]
+                    + source[(static_cast<size_t>(y1) * width + x0) * 4 + c] + source[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+                target[(static_cast<size_t>(y) * targetWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+// Row read for y past the bottom edge: the rows bounce back and forth (0 1 2 1 0 1 ...), so a block that
+// is 2 or 3 rows high holds the same pixels whichever way up the image is
+int mirrorRow(int y, int height) {
+    if (height == 1) {
+        return 0;
+    }
+    int period = 2 * (height - 1);
+    y %= period;
+    return y < height ? y : period - y;
+}
+
+// Encodes one level block by block; partial blocks repeat the last column and mirror the last rows
+void encodeLevel(const std::vector<unsigned char>& rgba, int width, int height, bool alpha, std::vector<unsigned char>& out) {
+    size_t blockSize = alpha ? 16 : 8;
+    size_t offset = out.size();
+    out.resize(offset + levelSize(width, height, blockSize));
+    unsigned char block[16 * 4];
+    for (int by = 0; by < (height + 3) / 4; ++by) {
+        for (int bx = 0; bx < (width + 3) / 4; ++bx) {
+            for (int py = 0; py < 4; ++py) {
+                int y = mirrorRow(by * 4 + py, height);
+                for (int px = 0; px < 4; ++px) {
+                    int x = std::min(bx * 4 + px, width - 1);
+                    std::memcpy(block + (py * 4 + px) * 4, &rgba[(static_cast<size_t>(y) * width + x) * 4], 4);
+                }
+            }
+            stb_compress_dxt_block(&out[offset], block, alpha ? 1 : 0, STB_DXT_HIGHQUAL);
+            offset += blockSize;
+        }
+    }
+}
+
+// Reverses rows first .. first + count - 1 of a BC1 colour block; each row is one byte of 2-bit indices
+void flipColorRows(unsigned char* block, int first, int count) {
+    std::reverse(block + 4 + first, block + 4 + first + count);
+}
+
+// Reverses rows first .. first + count - 1 of a BC3 alpha block; each row is 12 bits of 3-bit indices
+void flipAlphaRows(unsigned char* block, int first, int count) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) {
+        bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+    }
+    uint64_t flipped = bits;
+    for (int row = first; row < first + count; ++row) {
+        int target = 2 * first + count - 1 - row;
+        flipped &= ~(0xFFFull << (12 * target));
+        flipped |= ((bits >> (12 * row)) & 0xFFF) << (12 * target);
+    }
+    for (int i = 0; i < 6; ++i) {
+        block[2 + i] = static_cast<unsigned char>(flipped >> (8 * i));
+    }
+}
+
+// Flips a level upside down by reversing its block rows and the pixel rows inside every block. A height
+// that is not a multiple of 4 would move pixels between blocks, which only works for a single block row.
+// There the image rows and the padding rows are reversed separately, which turns the mirrored padding
+// of encodeLevel into that of the flipped image, so the result matches encoding the flipped level.
+bool flipLevel(unsigned char* data, int width, int height, size_t blockSize) {
+    if (height > 4 && height % 4 != 0) {
+        return false;
+    }
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t rowBytes = blocksX * blockSize;
+    for (int y = 0; y < blocksY / 2; ++y) {
+        std::swap_ranges(data + y * rowBytes, data + (y + 1) * rowBytes, data + (blocksY - 1 - y) * rowBytes);
+    }
+    int rows = std::min(height, 4);
+    for (size_t offset = 0; offset < blocksY * rowBytes; offset += blockSize) {
+        unsigned char* colorBlock = blockSize == 16 ? data + offset + 8 : data + offset;
+        if (blockSize == 16) {
+            flipAlphaRows(data + offset, 0, rows);
+            flipAlphaRows(data + offset, rows, 4 - rows);
+        }
+        flipColorRows(colorBlock, 0, rows);
+        flipColorRows(colorBlock, rows, 4 - rows);
+    }
+    return true;
+}
+
+} // namespace
+
+bool InitTextureCompression() {
+    enabled = false;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) {
+            enabled = true;
+        }
+    }
+    return enabled;
+}
+
+bool IsTextureCompressionEnabled() {
+    return enabled;
+}
+
+std::string CompressedTexturePath(const std::string& imagePath) {
+    size_t dot = imagePath.find_last_of('.');
+    size_t slash = imagePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return imagePath + COMPRESSED_TEXTURE_EXTENSION;
+    }
+    return imagePath.substr(0, dot) + COMPRESSED_TEXTURE_EXTENSION;
+}
+
+bool CompressTexture(const std::string& imagePath, const std::string& ktxPath, bool flipVertically) {
+    int width, height, channels;
+    if (!stbi_info(imagePath.c_str(), &width, &height, &channels)) {
+        std::cerr << "ERROR::TEXTURE_COMPRESSION::FAILED_TO_LOAD_IMAGE: " << imagePath << std::endl;
+        return false;
+    }
+    // Asking for four channels always decodes the image itself, never an existing compressed copy
+    ImageData image;
+    if (!LoadImageData(imagePath, flipVertically, image, 4)) {
+        return false;
+    }
+    bool alpha = channels == 2 || channels == 4;
+    GLenum format = alpha ? COMPRESSED_RGBA_S3TC_DXT5 : COMPRESSED_RGB_S3TC_DXT1;
+
+    std::vector<unsigned char> blocks;
+    std::vector<uint32_t> levelSizes;
+    std::vector<unsigned char> level = std::move(image.pixels), smaller;
+    int levelWidth = width, levelHeight = height;
+    while (true) {
+        size_t before = blocks.size();
+        encodeLevel(level, levelWidth, levelHeight, alpha, blocks);
+        levelSizes.push_back(static_cast<uint32_t>(blocks.size() - before));
+        if (levelWidth == 1 && levelHeight == 1) {
+            break;
+        }
+        downsample(level, levelWidth, levelHeight, smaller, levelWidth, levelHeight);
+        level.swap(smaller);
+    }
+
+    const char topDown[] = "KTXorientation\0S=r,T=d";
+    const char bottomUp[] = "KTXorientation\0S=r,T=u";
+    const char* orientationKey = flipVertically ? bottomUp : topDown;
+    uint32_t keyValueSize = sizeof(topDown);
+    uint32_t keyValuePadding = (4 - keyValueSize % 4) % 4;
+
+    KTXHeader header;
+    std::memcpy(header.identifier, KTX_IDENTIFIER, sizeof(header.identifier));
+    header.endianness = KTX_ENDIANNESS;
+    header.glType = 0;
+    header.glTypeSize = 1;
+    header.glFormat = 0;
+    header.glInternalFormat = format;
+    header.glBaseInternalFormat = alpha ? GL_RGBA : GL_RGB;
+    header.pixelWidth = static_cast<uint32_t>(width);
+    header.pixelHeight = static_cast<uint32_t>(height);
+    header.pixelDepth = 0;
+    header.numberOfArrayElements = 0;
+    header.numberOfFaces = 1;
+    header.numberOfMipmapLevels = static_cast<uint32_t>(levelSizes.size());
+    header.bytesOfKeyValueData = sizeof(keyValueSize) + keyValueSize + keyValuePadding;
+
+    // An interrupted conversion never leaves a truncated texture behind
+    bool written = WriteFileAtomically(ktxPath, [&](std::ostream& out) {
+        const char padding[4] = { 0, 0, 0, 0 };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&keyValueSize), sizeof(keyValueSize));
+        out.write(orientationKey, keyValueSize);
+        out.write(padding, keyValuePadding);
+        size_t offset = 0;
+        for (uint32_t size : levelSizes) {
+            // Every level is a whole number of 8 or 16 byte blocks, so no mip padding is needed
+            out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            out.write(reinterpret_cast<const char*>(&blocks[offset]), size);
+            offset += size;
+        }
+    });
+    if (!written) {
+        std::cerr << "ERROR::TEXTURE_COMPRESSION::FAILED_TO_WRITE: " << ktxPath << std::endl;
+        return false;
+    }
+
+    size_t uncompressed = static_cast<size_t>(width) * height * (alpha ? 4 : 3);
+    std::cout << "Compressed " << imagePath << " (" << width << "x" << height << ", " << levelSizes.size() << " levels) to "
+        << ktxPath << " as " << (alpha ? "BC3" : "BC1") << (flipVertically ? ", bottom row first" : "") << ": " << blocks.size() / 1024 << " KB with mips, "
+        << uncompressed / 1024 << " KB for the top level uncompressed" << std::endl;
+    return true;
+}
+
+bool LoadCompressedTexture(const std::string& ktxPath, bool flipVertically, ImageData& image) {
+    std::ifstream in(ktxPath, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    KTXHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.identifier, KTX_IDENTIFIER, sizeof(header.identifier)) != 0
+        || header.endianness != KTX_ENDIANNESS || header.glType != 0
+        || (header.glInternalFormat != COMPRESSED_RGB_S3TC_DXT1 && header.glInternalFormat != COMPRESSED_RGBA_S3TC_DXT5)
+        || header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth != 0
+        || header.numberOfArrayElements != 0 || header.numberOfFaces != 1) {
+        std::cerr << "ERROR::TEXTURE_COMPRESSION::UNSUPPORTED_KTX: " << ktxPath << std::endl;
+        return false;
+    }
+
+    // Entries are a uint32 size, then the key and value, each terminated by a zero, padded to 4 bytes
+    std::vector<char> keyValueData(header.bytesOfKeyValueData);
+    if (!in.read(keyValueData.data(), keyValueData.size())) {
+        std::cerr << "ERROR::TEXTURE_COMPRESSION::CORRUPT_KTX: " << ktxPath << std::endl;
+        return false;
+    }
+    bool storedBottomUp = false;
+    for (size_t offset = 0; offset + sizeof(uint32_t) <= keyValueData.size();) {
+        uint32_t size = 0;
+        std::memcpy(&size, &keyValueData[offset], sizeof(size));
+        offset += sizeof(size);
+        if (size > keyValueData.size() - offset) {
+            break;
+        }
+        std::string entry(&keyValueData[offset], size);
+        size_t split = entry.find('\0');
+        if (split != std::string::npos && entry.compare(0, split, "KTXorientation") == 0) {
+            storedBottomUp = entry.find("T=u", split) != std::string::npos;
+        }
+        offset += size + (4 - size % 4) % 4;
+    }
+    bool flip = flipVertically != storedBottomUp;
+
+    ImageData result;
+    result.width = static_cast<int>(header.pixelWidth);
+    result.height = static_cast<int>(header.pixelHeight);
+    result.channels = header.glInternalFormat == COMPRESSED_RGB_S3TC_DXT1 ? 3 : 4;
+    result.compressedFormat = header.glInternalFormat;
+    size_t blockSize = blockSizeOf(header.glInternalFormat);
+
+    // Zero levels asks the loader to generate mips; only the top level is stored then
+    uint32_t levels = std::max(header.numberOfMipmapLevels, 1u);
+    int levelWidth = result.width, levelHeight = result.height;
+    for (uint32_t level = 0; level < levels; ++level) {
+        uint32_t size = 0;
+        if (!in.read(reinterpret_cast<char*>(&size), sizeof(size)) || size != levelSize(levelWidth, levelHeight, blockSize)) {
+            std::cerr << "ERROR::TEXTURE_COMPRESSION::CORRUPT_KTX: " << ktxPath << std::endl;
+            return false;
+        }
+        size_t offset = result.pixels.size();
+        result.pixels.resize(offset + size);
+        if (!in.read(reinterpret_cast<char*>(&result.pixels[offset]), size)) {
+            std::cerr << "ERROR::TEXTURE_COMPRESSION::CORRUPT_KTX: " << ktxPath << std::endl;
+            return false;
+        }
+        if (flip && !flipLevel(&result.pixels[offset], levelWidth, levelHeight, blockSize)) {
+            std::cerr << "ERROR::TEXTURE_COMPRESSION::CANNOT_FLIP: " << ktxPath << " has a " << levelWidth << "x"
+                << levelHeight << " level; compress it " << (flipVertically ? "with" : "without") << " --flip" << std::endl;
+            return false;
+        }
+        result.levelSizes.push_back(size);
+        levelWidth = std::max(levelWidth / 2, 1);
+        levelHeight = std::max(levelHeight / 2, 1);
+    }
+
+    image = std::move(result);
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef TEXTURE_COMPRESSION_H
+#define TEXTURE_COMPRESSION_H
+
+#include <cstdint>
+#include <string>
+#include <glad/glad.h>
+#include "AssetLoader.h"
+
+// Block-compressed textures in KTX 1.1 containers, stored next to the image they replace with the
+// extension swapped: assets/textures/terrain_texture.png -> assets/textures/terrain_texture.ktx.
+// Images without alpha are encoded as BC1 (DXT1, 4 bits per pixel), images with alpha as BC3
+// (DXT5, 8 bits per pixel), each with its complete mip chain.
+const char* const COMPRESSED_TEXTURE_EXTENSION = ".ktx";
+
+// GL_EXT_texture_compression_s3tc, not part of the 3.3 core loader
+const GLenum COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+const GLenum COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+
+const uint8_t KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+const uint32_t KTX_ENDIANNESS = 0x04030201;
+
+// Followed by bytesOfKeyValueData of metadata, then for each mip level a uint32 byte size and the
+// level's blocks. KTXorientation in the metadata says whether the first row of blocks is the top
+// ("T=d", the default) or the bottom ("T=u") of the image.
+#pragma pack(push, 1)
+struct KTXHeader {
+    uint8_t identifier[12];
+    uint32_t endianness;
+    uint32_t glType;                 // 0 for compressed formats
+    uint32_t glTypeSize;
+    uint32_t glFormat;               // 0 for compressed formats
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+};
+#pragma pack(pop)
+
+// Checks for S3TC support. Call on the GL thread before images are loaded; until then, and on drivers
+// without S3TC, LoadImageData ignores compressed files and decodes the original image.
+bool InitTextureCompression();
+bool IsTextureCompressionEnabled();
+
+// Path of the compressed copy of an image
+std::string CompressedTexturePath(const std::string& imagePath);
+
+// Offline step: box-filters the image down to 1x1 and encodes every level with stb_dxt. flipVertically
+// stores the image bottom row first, matching a loader that flips it, so it loads without flipping blocks.
+bool CompressTexture(const std::string& imagePath, const std::string& ktxPath, bool flipVertically = false);
+
+// Reads a BC1 or BC3 KTX file; safe to call from any thread. flipVertically asks for the bottom row first
+// like stb_image. A file stored the other way round is flipped block by block, which needs every mip
+// level's height to be a multiple of 4 or below 4. Returns false without an error when the file does not exist.
+bool LoadCompressedTexture(const std::string& ktxPath, bool flipVertically, ImageData& image);
+
+#endif
@@ -0,0 +1,205 @@
+#include "TiledHeightmap.h"
+#include "Terrain.h"
+#include "FileUtils.h"
+#include <stb/stb_image.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+bool ConvertHeightmapToTiles(const std::string& imagePath, const std::string& outputPath, int tileSize) {
+    if (tileSize <= 0) {
+        return false;
+    }
+
+    // Same orientation as Terrain::LoadHeightmapData; 8-bit images are widened to 16 bits by stb
+    stbi_set_flip_vertically_on_load_thread(true);
+    int width, height, channels;
+    stbi_us* image = stbi_load_16(imagePath.c_str(), &width, &height, &channels, STBI_grey);
+    if (!image) {
+        std::cerr << "ERROR::TILED_HEIGHTMAP::FAILED_TO_LOAD_IMAGE: " << imagePath << std::endl;
+        return false;
+    }
+
+    TiledHeightmapHeader header;
+    std::memcpy(header.magic, TILED_HEIGHTMAP_MAGIC, sizeof(header.magic));
+    header.version = TILED_HEIGHTMAP_VERSION;
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.tileSize = static_cast<uint32_t>(tileSize);
+    header.tilesX = static_cast<uint32_t>((width + tileSize - 1) / tileSize);
+    header.tilesZ = static_cast<uint32_t>((height + tileSize - 1) / tileSize);
+    header.heightOffset = 0.0f;
+    header.heightRange = TERRAIN_HEIGHT_SCALE;
+
+    // Tiles follow the header in row-major order and the index goes last
+    size_t tileCount = static_cast<size_t>(header.tilesX) * header.tilesZ;
+    uint32_t tileBytes = static_cast<uint32_t>(static_cast<size_t>(tileSize) * tileSize * sizeof(uint16_t));
+    header.indexOffset = sizeof(header) + tileCount * tileBytes;
+    std::vector<TiledHeightmapTileEntry> entries(tileCount);
+    for (size_t i = 0; i < tileCount; ++i) {
+        entries[i].offset = sizeof(header) + i * tileBytes;
+        entries[i].byteSize = tileBytes;
+        entries[i].reserved = 0;
+    }
+
+    // An interrupted conversion never leaves a truncated file that is newer than the image
+    bool written = WriteFileAtomically(outputPath, [&](std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::vector<uint16_t> tile(static_cast<size_t>(tileSize) * tileSize);
+        for (int tileZ = 0; tileZ < static_cast<int>(header.tilesZ); ++tileZ) {
+            for (int tileX = 0; tileX < static_cast<int>(header.tilesX); ++tileX) {
+                for (int z = 0; z < tileSize; ++z) {
+                    int sourceZ = std::min(tileZ * tileSize + z, height - 1);
+                    for (int x = 0; x < tileSize; ++x) {
+                        int sourceX = std::min(tileX * tileSize + x, width - 1);
+                        tile[static_cast<size_t>(z) * tileSize + x] = image[static_cast<size_t>(sourceZ) * width + sourceX];
+                    }
+                }
+                out.write(reinterpret_cast<const char*>(tile.data()), tileBytes);
+            }
+        }
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(TiledHeightmapTileEntry));
+    });
+    stbi_image_free(image);
+    if (!written) {
+        std::cerr << "ERROR::TILED_HEIGHTMAP::FAILED_TO_WRITE: " << outputPath << std::endl;
+        return false;
+    }
+
+    std::cout << "Converted " << imagePath << " to " << outputPath << " [" << width << "x" << height << ", "
+        << header.tilesX << "x" << header.tilesZ << " tiles of " << tileSize << "]" << std::endl;
+    return true;
+}
+
+TiledHeightmap::TiledHeightmap() : header(), index(nullptr), budgetTiles(0), tileLoads(0), tileEvictions(0) {
+}
+
+bool TiledHeightmap::Open(const std::string& path, size_t residentBudgetBytes) {
+    Close();
+    if (!file.Open(path)) {
+        std::cerr << "ERROR::TILED_HEIGHTMAP::FAILED_TO_MAP: " << path << std::endl;
+        return false;
+    }
+
+    if (file.GetSize() < sizeof(TiledHeightmapHeader)) {
+        std::cerr << "ERROR::TILED_HEIGHTMAP::TRUNCATED: " << path << std::endl;
+        file.Close();
+        return false;
+    }
+    std::memcpy(&header, file.GetData(), sizeof(header));
+
+    size_t tileCount = static_cast<size_t>(header.tilesX) * header.tilesZ;
+    size_t tileBytes = static_cast<size_t>(header.tileSize) * header.tileSize * sizeof(uint16_t);
+    bool valid = std::memcmp(header.magic, TILED_HEIGHTMAP_MAGIC, sizeof(header.magic)) == 0
+        && header.version == TILED_HEIGHTMAP_VERSION
+        && header.tileSize > 0 && header.width > 0 && header.height > 0
+        && header.tilesX == (header.width + header.tileSize - 1) / header.tileSize
+        && header.tilesZ == (header.height + header.tileSize - 1) / header.tileSize
+        && header.indexOffset + tileCount * sizeof(TiledHeightmapTileEntry) <= file.GetSize();
+    if (valid) {
+        index = reinterpret_cast<const TiledHeightmapTileEntry*>(file.GetData() + header.indexOffset);
+        for (size_t i = 0; i < tileCount && valid; ++i) {
+            valid = index[i].byteSize == tileBytes && index[i].offset + tileBytes <= file.GetSize();
+        }
+    }
+    if (!valid) {
+        std::cerr << "ERROR::TILED_HEIGHTMAP::INVALID_FILE: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    budgetTiles = std::max<size_t>(1, residentBudgetBytes / (static_cast<size_t>(header.tileSize) * header.tileSize * sizeof(float)));
+    return true;
+}
+
+void TiledHeightmap::Close() {
+    file.Close();
+    header = TiledHeightmapHeader();
+    index = nullptr;
+    lru.clear();
+    residentTiles.clear();
+}
+
+const uint16_t* TiledHeightmap::tileSamples(int tileIndex) const {
+    return reinterpret_cast<const uint16_t*>(file.GetData() + index[tileIndex].offset);
+}
+
+const float* TiledHeightmap::AcquireTile(int tileX, int tileZ) {
+    if (!index || tileX < 0 || tileZ < 0 || tileX >= static_cast<int>(header.tilesX) || tileZ >= static_cast<int>(header.tilesZ)) {
+        return nullptr;
+    }
+    int tileIndex = tileZ * static_cast<int>(header.tilesX) + tileX;
+
+    auto found = residentTiles.find(tileIndex);
+    if (found != residentTiles.end()) {
+        lru.splice(lru.begin(), lru, found->second.lruPosition);
+        return found->second.heights.data();
+    }
+
+    // Decode from the mapping; the OS pages the samples in from disk as they are touched
+    ResidentTile& tile = residentTiles[tileIndex];
+    size_t sampleCount = static_cast<size_t>(header.tileSize) * header.tileSize;
+    tile.heights.resize(sampleCount);
+    const uint16_t* samples = tileSamples(tileIndex);
+    for (size_t i = 0; i < sampleCount; ++i) {
+        tile.heights[i] = decode(samples[i]);
+    }
+    lru.push_front(tileIndex);
+    tile.lruPosition = lru.begin();
+    ++tileLoads;
+
+    const float* heights = tile.heights.data();
+    evictOverBudget();
+    return heights;
+}
+
+void TiledHeightmap::evictOverBudget() {
+    // Never evicts the most recently used tile, which the caller may still hold
+    while (residentTiles.size() > budgetTiles && lru.size() > 1) {
+        residentTiles.erase(lru.back());
+        lru.pop_back();
+        ++tileEvictions;
+    }
+}
+
+void TiledHeightmap::Update(const glm::vec3& position, float radius) {
+    if (!index) {
+        return;
+    }
+    int tileSize = static_cast<int>(header.tileSize);
+    int minTileX = std::max(0, static_cast<int>((position.x - radius) / tileSize));
+    int maxTileX = std::min(static_cast<int>(header.tilesX) - 1, static_cast<int>((position.x + radius) / tileSize));
+    int minTileZ = std::max(0, static_cast<int>((position.z - radius) / tileSize));
+    int maxTileZ = std::min(static_cast<int>(header.tilesZ) - 1, static_cast<int>((position.z + radius) / tileSize));
+
+    // Touch the nearest tiles last so they end up most recently used
+    std::vector<std::pair<float, int>> wanted;
+    for (int tileZ = minTileZ; tileZ <= maxTileZ; ++tileZ) {
+        for (int tileX = minTileX; tileX <= maxTileX; ++tileX) {
+            glm::vec2 center((tileX + 0.5f) * tileSize, (tileZ + 0.5f) * tileSize);
+            float distance = glm::length(center - glm::vec2(position.x, position.z));
+            wanted.push_back(std::make_pair(distance, tileZ * static_cast<int>(header.tilesX) + tileX));
+        }
+    }
+    std::sort(wanted.begin(), wanted.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+    for (const auto& tile : wanted) {
+        AcquireTile(tile.second % static_cast<int>(header.tilesX), tile.second / static_cast<int>(header.tilesX));
+    }
+}
+
+float TiledHeightmap::GetSample(int x, int z) const {
+    if (!index) {
+        return 0.0f;
+    }
+    x = std::min(std::max(x, 0), static_cast<int>(header.width) - 1);
+    z = std::min(std::max(z, 0), static_cast<int>(header.height) - 1);
+    int tileSize = static_cast<int>(header.tileSize);
+    int tileIndex = (z / tileSize) * static_cast<int>(header.tilesX) + x / tileSize;
+    size_t local = static_cast<size_t>(z % tileSize) * tileSize + x % tileSize;
+
+    auto found = residentTiles.find(tileIndex);
+    if (found != residentTiles.end()) {
+        return found->second.heights[local];
+    }
+    return decode(tileSamples(tileIndex)[local]);
+}
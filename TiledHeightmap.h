@@ -0,0 +1,93 @@
+#ifndef TILED_HEIGHTMAP_H
+#define TILED_HEIGHTMAP_H
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MappedFile.h"
+
+// On-disk tiled heightmap (.hmt). Little-endian layout:
+//   TiledHeightmapHeader
+//   tilesX * tilesZ tiles of tileSize * tileSize uint16 heights, row-major; edge tiles repeat the last sample
+//   tilesX * tilesZ TiledHeightmapTileEntry records at indexOffset, row-major by tile
+const char TILED_HEIGHTMAP_MAGIC[4] = { 'H', 'M', 'T', '1' };
+const uint32_t TILED_HEIGHTMAP_VERSION = 1;
+const int TILED_HEIGHTMAP_DEFAULT_TILE_SIZE = 256;
+
+#pragma pack(push, 1)
+struct TiledHeightmapHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t tilesX;
+    uint32_t tilesZ;
+    float heightOffset;  // height = heightOffset + sample / 65535 * heightRange
+    float heightRange;
+    uint64_t indexOffset;
+};
+
+struct TiledHeightmapTileEntry {
+    uint64_t offset;     // Byte offset of the tile's samples
+    uint32_t byteSize;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+
+// Converts a greyscale image (8 or 16 bit) into the tiled format, using the same height scale as Terrain
+bool ConvertHeightmapToTiles(const std::string& imagePath, const std::string& outputPath, int tileSize = TILED_HEIGHTMAP_DEFAULT_TILE_SIZE);
+
+// Memory-mapped tiled heightmap. Tiles are decoded to floats on demand and kept in an LRU cache
+// bounded by a byte budget, so only the area around the camera needs to be resident.
+class TiledHeightmap {
+public:
+    TiledHeightmap();
+
+    bool Open(const std::string& path, size_t residentBudgetBytes = 64 * 1024 * 1024);
+    void Close();
+
+    bool IsOpen() const { return index != nullptr; }
+    int GetWidth() const { return static_cast<int>(header.width); }
+    int GetHeight() const { return static_cast<int>(header.height); }
+    int GetTileSize() const { return static_cast<int>(header.tileSize); }
+
+    // Pages in every tile within radius of the position (X/Z), evicting least recently used tiles over budget
+    void Update(const glm::vec3& position, float radius);
+
+    // Decoded tile samples (tileSize * tileSize floats), paging the tile in if needed
+    const float* AcquireTile(int tileX, int tileZ);
+
+    // Height of one grid sample; resident tiles are used, others are read straight from the mapping
+    // Not safe to call while another thread acquires tiles.
+    float GetSample(int x, int z) const;
+
+    size_t GetResidentTileCount() const { return residentTiles.size(); }
+    size_t GetBudgetTiles() const { return budgetTiles; }
+    size_t GetTileLoads() const { return tileLoads; }
+    size_t GetTileEvictions() const { return tileEvictions; }
+
+private:
+    struct ResidentTile {
+        std::vector<float> heights;
+        std::list<int>::iterator lruPosition;
+    };
+
+    MappedFile file;
+    TiledHeightmapHeader header;
+    const TiledHeightmapTileEntry* index;
+    size_t budgetTiles;
+    std::list<int> lru;  // Most recently used first
+    std::unordered_map<int, ResidentTile> residentTiles;
+    size_t tileLoads;
+    size_t tileEvictions;
+
+    const uint16_t* tileSamples(int tileIndex) const;
+    float decode(uint16_t sample) const { return header.heightOffset + static_cast<float>(sample) / 65535.0f * header.heightRange; }
+    void evictOverBudget();
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "Track.h"
+#include <algorithm>
+#include <cmath>
+
+const int64_t* TrackSlice::Times() const {
+    return track->GetTimes().data() + first;
+}
+
+const double* TrackSlice::Latitudes() const {
+    return track->GetLatitudes().data() + first;
+}
+
+const double* TrackSlice::Longitudes() const {
+    return track->GetLongitudes().data() + first;
+}
+
+const float* TrackSlice::Channel(Track_Channel channel) const {
+    return track->GetChannel(channel).data() + first;
+}
+
+void Track::Clear() {
+    times.clear();
+    latitudes.clear();
+    longitudes.clear();
+    for (std::vector<float>& channel : channels) {
+        channel.clear();
+    }
+}
+
+void Track::Reserve(size_t count) {
+    times.reserve(count);
+    latitudes.reserve(count);
+    longitudes.reserve(count);
+    for (std::vector<float>& channel : channels) {
+        channel.reserve(count);
+    }
+}
+
+size_t Track::AddPoint(double latitude, double longitude) {
+    times.push_back(TRACK_TIME_UNKNOWN);
+    latitudes.push_back(latitude);
+    longitudes.push_back(longitude);
+    for (std::vector<float>& channel : channels) {
+        channel.push_back(TRACK_NO_VALUE);
+    }
+    return latitudes.size() - 1;
+}
+
+void Track::Assign(size_t count, const int64_t* pointTimes, const double* pointLatitudes, const double* pointLongitudes,
+    const float* const channelValues[TRACK_CHANNEL_COUNT]) {
+    times.assign(pointTimes, pointTimes + count);
+    latitudes.assign(pointLatitudes, pointLatitudes + count);
+    longitudes.assign(pointLongitudes, pointLongitudes + count);
+    for (int channel = 0; channel < TRACK_CHANNEL_COUNT; ++channel) {
+        channels[channel].assign(channelValues[channel], channelValues[channel] + count);
+    }
+}
+
+bool Track::HasChannel(Track_Channel channel) const {
+    const std::vector<float>& values = channels[channel];
+    return std::any_of(values.begin(), values.end(), [](float value) { return !std::isnan(value); });
+}
+
+bool Track::IsTimeOrdered() const {
+    if (!times.empty() && times.front() == TRACK_TIME_UNKNOWN) {
+        return false;
+    }
+    return std::is_sorted(times.begin(), times.end());
+}
+
+TrackSlice Track::SliceByTime(int64_t begin, int64_t end) const {
+    size_t first = std::lower_bound(times.begin(), times.end(), begin) - times.begin();
+    size_t last = std::lower_bound(times.begin() + first, times.end(), end) - times.begin();
+    TrackSlice slice = { this, first, last };
+    return slice;
+}
+
+TrackSlice Track::All() const {
+    TrackSlice slice = { this, 0, Size() };
+    return slice;
+}
@@ -0,0 +1,79 @@
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Time of a point recorded without a timestamp
+const int64_t TRACK_TIME_UNKNOWN = std::numeric_limits<int64_t>::min();
+// Value of a channel the point was recorded without
+const float TRACK_NO_VALUE = std::numeric_limits<float>::quiet_NaN();
+
+// Per-point measurements stored as float columns
+enum Track_Channel {
+    CHANNEL_ELEVATION,   // Metres
+    CHANNEL_HEART_RATE,  // Beats per minute
+    CHANNEL_CADENCE,     // Revolutions or steps per minute
+    CHANNEL_TEMPERATURE, // Degrees Celsius
+    TRACK_CHANNEL_COUNT
+};
+
+class Track;
+
+// Contiguous range of a track's points; shares the track's columns, so it is only valid while the track is unchanged
+struct TrackSlice {
+    const Track* track;
+    size_t first;
+    size_t last;  // One past the final point
+
+    size_t Size() const { return last - first; }
+    bool Empty() const { return last == first; }
+
+    const int64_t* Times() const;
+    const double* Latitudes() const;
+    const double* Longitudes() const;
+    const float* Channel(Track_Channel channel) const;
+};
+
+// Recorded activity stored as structure of arrays: one column per channel, indexed by point
+class Track {
+public:
+    size_t Size() const { return latitudes.size(); }
+    bool Empty() const { return latitudes.empty(); }
+    void Clear();
+    void Reserve(size_t count);
+
+    // Appends a point without a time or channel values and returns its index
+    size_t AddPoint(double latitude, double longitude);
+    void SetTime(size_t index, int64_t time) { times[index] = time; }
+    void SetValue(Track_Channel channel, size_t index, float value) { channels[channel][index] = value; }
+    // Replaces the whole track with count points copied from columns, e.g. a memory-mapped cache
+    void Assign(size_t count, const int64_t* pointTimes, const double* pointLatitudes, const double* pointLongitudes,
+        const float* const channelValues[TRACK_CHANNEL_COUNT]);
+
+    // Milliseconds since the Unix epoch (UTC), or TRACK_TIME_UNKNOWN
+    const std::vector<int64_t>& GetTimes() const { return times; }
+    const std::vector<double>& GetLatitudes() const { return latitudes; }
+    const std::vector<double>& GetLongitudes() const { return longitudes; }
+    // Values of one channel, TRACK_NO_VALUE where the point has none
+    const std::vector<float>& GetChannel(Track_Channel channel) const { return channels[channel]; }
+
+    // True if at least one point has a value for the channel
+    bool HasChannel(Track_Channel channel) const;
+    // True if every point has a time and times never decrease; required by SliceByTime
+    bool IsTimeOrdered() const;
+
+    // Points with begin <= time < end, found by binary search without copying
+    TrackSlice SliceByTime(int64_t begin, int64_t end) const;
+    TrackSlice All() const;
+
+private:
+    std::vector<int64_t> times;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<float> channels[TRACK_CHANNEL_COUNT];
+};
+
+#endif
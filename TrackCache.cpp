@@ -0,0 +1,201 @@
+#include "TrackCache.h"
+#include "FileUtils.h"
+#include "GpxReader.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+const size_t TRACK_CACHE_ALIGNMENT = 8;
+
+size_t alignUp(size_t value) {
+    return (value + TRACK_CACHE_ALIGNMENT - 1) & ~(TRACK_CACHE_ALIGNMENT - 1);
+}
+
+// FNV-1a over the whole file
+bool hashFile(const std::string& path, uint64_t& hash) {
+    MappedFile file;
+    if (!file.Open(path)) {
+        return false;
+    }
+    hash = HashFnv1a(FNV1A_OFFSET_BASIS, file.GetData(), file.GetSize());
+    return true;
+}
+
+bool columnFits(uint64_t offset, uint64_t count, size_t elementSize, size_t fileSize) {
+    return offset % TRACK_CACHE_ALIGNMENT == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+}
+
+} // namespace
+
+void ProjectTrack(ProjectedTrack& result) {
+    const std::vector<double>& latitudes = result.track.GetLatitudes();
+    const std::vector<double>& longitudes = result.track.GetLongitudes();
+    result.projected.resize(result.track.Size());
+    if (result.track.Empty()) {
+        return;
+    }
+
+    result.minLatitude = *std::min_element(latitudes.begin(), latitudes.end());
+    result.maxLatitude = *std::max_element(latitudes.begin(), latitudes.end());
+    result.minLongitude = *std::min_element(longitudes.begin(), longitudes.end());
+    result.maxLongitude = *std::max_element(longitudes.begin(), longitudes.end());
+
+    // A track along a meridian or parallel collapses to the middle of that axis
+    double latitudeRange = result.maxLatitude - result.minLatitude;
+    double longitudeRange = result.maxLongitude - result.minLongitude;
+    for (size_t i = 0; i < result.track.Size(); ++i) {
+        result.projected[i] = glm::vec2(
+            longitudeRange > 0.0 ? static_cast<float>((longitudes[i] - result.minLongitude) / longitudeRange) : 0.5f,
+            latitudeRange > 0.0 ? static_cast<float>((latitudes[i] - result.minLatitude) / latitudeRange) : 0.5f);
+    }
+}
+
+std::string TrackCachePath(const std::string& gpxPath) {
+    return gpxPath + ".trackcache";
+}
+
+bool LoadTrackCache(const std::string& gpxPath, ProjectedTrack& result) {
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    if (!GetFileStamp(gpxPath, sourceSize, sourceModified)) {
+        return false;
+    }
+
+    std::string cachePath = TrackCachePath(gpxPath);
+    MappedFile cache;
+    if (!cache.Open(cachePath) || cache.GetSize() < sizeof(TrackCacheHeader)) {
+        return false;
+    }
+    TrackCacheHeader header;
+    std::memcpy(&header, cache.GetData(), sizeof(header));
+    if (std::memcmp(header.magic, TRACK_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != TRACK_CACHE_VERSION) {
+        return false;
+    }
+
+    // Same size and time stamp is trusted; otherwise the contents decide, e.g. after a fresh checkout
+    bool restamp = false;
+    if (header.sourceSize != sourceSize || header.sourceModified != sourceModified) {
+        uint64_t sourceHash;
+        if (header.sourceSize != sourceSize || !hashFile(gpxPath, sourceHash) || sourceHash != header.sourceHash) {
+            return false;
+        }
+        restamp = true;
+    }
+
+    size_t size = cache.GetSize();
+    uint64_t count = header.pointCount;
+    bool valid = columnFits(header.timesOffset, count, sizeof(int64_t), size)
+        && columnFits(header.latitudesOffset, count, sizeof(double), size)
+        && columnFits(header.longitudesOffset, count, sizeof(double), size)
+        && columnFits(header.projectedOffset, count, sizeof(glm::vec2), size);
+    for (int channel = 0; channel < TRACK_CHANNEL_COUNT; ++channel) {
+        valid = valid && columnFits(header.channelOffsets[channel], count, sizeof(float), size);
+    }
+    if (!valid) {
+        std::cerr << "ERROR::TRACK_CACHE::INVALID_FILE: " << cachePath << std::endl;
+        return false;
+    }
+
+    // Columns are stored exactly as Track holds them, so loading is one copy per column
+    const unsigned char* data = cache.GetData();
+    const float* channelValues[TRACK_CHANNEL_COUNT];
+    for (int channel = 0; channel < TRACK_CHANNEL_COUNT; ++channel) {
+        channelValues[channel] = reinterpret_cast<const float*>(data + header.channelOffsets[channel]);
+    }
+    result.track.Assign(static_cast<size_t>(count), reinterpret_cast<const int64_t*>(data + header.timesOffset),
+        reinterpret_cast<const double*>(data + header.latitudesOffset), reinterpret_cast<const double*>(data + header.longitudesOffset),
+        channelValues);
+    const glm::vec2* projected = reinterpret_cast<const glm::vec2*>(data + header.projectedOffset);
+    result.projected.assign(projected, projected + count);
+    result.minLatitude = header.minLatitude;
+    result.maxLatitude = header.maxLatitude;
+    result.minLongitude = header.minLongitude;
+    result.maxLongitude = header.maxLongitude;
+    cache.Close();
+
+    // Remember the new time stamp so the next load can skip the hash
+    if (restamp) {
+        std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offsetof(TrackCacheHeader, sourceModified));
+        file.write(reinterpret_cast<const char*>(&sourceModified), sizeof(sourceModified));
+    }
+    return true;
+}
+
+bool WriteTrackCache(const std::string& gpxPath, const ProjectedTrack& track) {
+    TrackCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    if (!GetFileStamp(gpxPath, header.sourceSize, header.sourceModified) || !hashFile(gpxPath, header.sourceHash)) {
+        return false;
+    }
+    std::memcpy(header.magic, TRACK_CACHE_MAGIC, sizeof(header.magic));
+    header.version = TRACK_CACHE_VERSION;
+    header.pointCount = track.track.Size();
+    header.minLatitude = track.minLatitude;
+    header.maxLatitude = track.maxLatitude;
+    header.minLongitude = track.minLongitude;
+    header.maxLongitude = track.maxLongitude;
+
+    // Column order in the file
+    size_t count = track.track.Size();
+    std::vector<std::pair<const void*, size_t>> columns;
+    columns.push_back(std::make_pair(track.track.GetTimes().data(), count * sizeof(int64_t)));
+    columns.push_back(std::make_pair(track.track.GetLatitudes().data(), count * sizeof(double)));
+    columns.push_back(std::make_pair(track.track.GetLongitudes().data(), count * sizeof(double)));
+    for (int channel = 0; channel < TRACK_CHANNEL_COUNT; ++channel) {
+        columns.push_back(std::make_pair(track.track.GetChannel(static_cast<Track_Channel>(channel)).data(), count * sizeof(float)));
+    }
+    columns.push_back(std::make_pair(track.projected.data(), count * sizeof(glm::vec2)));
+
+    std::vector<uint64_t> offsets;
+    size_t offset = alignUp(sizeof(header));
+    for (const auto& column : columns) {
+        offsets.push_back(offset);
+        offset = alignUp(offset + column.second);
+    }
+    header.timesOffset = offsets[0];
+    header.latitudesOffset = offsets[1];
+    header.longitudesOffset = offsets[2];
+    for (int channel = 0; channel < TRACK_CHANNEL_COUNT; ++channel) {
+        header.channelOffsets[channel] = offsets[3 + channel];
+    }
+    header.projectedOffset = offsets.back();
+
+    // A reader never maps a half-written cache
+    std::string cachePath = TrackCachePath(gpxPath);
+    bool written = WriteFileAtomically(cachePath, [&](std::ostream& out) {
+        const char padding[TRACK_CACHE_ALIGNMENT] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        size_t position = sizeof(header);
+        for (size_t i = 0; i < columns.size(); ++i) {
+            out.write(padding, offsets[i] - position);
+            out.write(static_cast<const char*>(columns[i].first), columns[i].second);
+            position = offsets[i] + columns[i].second;
+        }
+    });
+    if (!written) {
+        std::cerr << "ERROR::TRACK_CACHE::FAILED_TO_WRITE: " << cachePath << std::endl;
+    }
+    return written;
+}
+
+bool LoadTrackCached(const std::string& gpxPath, ProjectedTrack& result) {
+    if (LoadTrackCache(gpxPath, result)) {
+        return true;
+    }
+    if (!ReadGpx(gpxPath, result.track)) {
+        return false;
+    }
+    ProjectTrack(result);
+    if (!result.track.Empty()) {
+        WriteTrackCache(gpxPath, result);
+    }
+    return true;
+}
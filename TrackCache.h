@@ -0,0 +1,59 @@
+#ifndef TRACK_CACHE_H
+#define TRACK_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Track.h"
+
+// Binary sidecar written next to a GPX file (<file>.trackcache) so later loads skip the XML.
+// Little-endian layout:
+//   TrackCacheHeader
+//   columns at the offsets in the header, each 8-byte aligned:
+//     times (int64), latitudes (double), longitudes (double), one float column per channel,
+//     projected points (2 floats per point)
+const char TRACK_CACHE_MAGIC[4] = { 'T', 'R', 'K', 'C' };
+const uint32_t TRACK_CACHE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct TrackCacheHeader {
+    char magic[4];
+    uint32_t version;
+    // Source GPX key; the cache is stale when the file no longer matches
+    uint64_t sourceSize;
+    int64_t sourceModified;   // Seconds since the Unix epoch
+    uint64_t sourceHash;      // FNV-1a of the file contents
+    uint64_t pointCount;
+    // Geographic bounds used for the projection
+    double minLatitude, maxLatitude;
+    double minLongitude, maxLongitude;
+    uint64_t timesOffset;
+    uint64_t latitudesOffset;
+    uint64_t longitudesOffset;
+    uint64_t channelOffsets[TRACK_CHANNEL_COUNT];
+    uint64_t projectedOffset;
+};
+#pragma pack(pop)
+
+// Track plus its points projected onto the unit square: x from longitude, y from latitude, both in [0, 1]
+struct ProjectedTrack {
+    Track track;
+    std::vector<glm::vec2> projected;
+    double minLatitude = 0.0, maxLatitude = 0.0;
+    double minLongitude = 0.0, maxLongitude = 0.0;
+};
+
+// Fills the bounds and projected points from the track's positions
+void ProjectTrack(ProjectedTrack& result);
+
+std::string TrackCachePath(const std::string& gpxPath);
+
+// Maps the sidecar and copies its columns out if it matches the GPX file; false on a miss
+bool LoadTrackCache(const std::string& gpxPath, ProjectedTrack& result);
+bool WriteTrackCache(const std::string& gpxPath, const ProjectedTrack& track);
+
+// Cached load if possible; otherwise parses the GPX file and writes the sidecar for next time
+bool LoadTrackCached(const std::string& gpxPath, ProjectedTrack& result);
+
+#endif
@@ -0,0 +1,53 @@
+#include "UniformBlocks.h"
+#include "Light.h"
+
+FrameUniforms::FrameUniforms() : frameBuffer(0), lightingBuffer(0), frame(), lighting() {
+}
+
+FrameUniforms::~FrameUniforms() {
+    if (frameBuffer != 0) {
+        glDeleteBuffers(1, &frameBuffer);
+        glDeleteBuffers(1, &lightingBuffer);
+    }
+}
+
+void FrameUniforms::Create() {
+    glGenBuffers(1, &frameBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, frameBuffer);
+
+    glGenBuffers(1, &lightingBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightingBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightingBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTING_BLOCK_BINDING, lightingBuffer);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::SetCamera(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& position, const glm::vec2& viewportSize) {
+    frame.projection = projection;
+    frame.view = view;
+    frame.viewProjection = projection * view;
+    frame.cameraPosition = glm::vec4(position, 1.0f);
+    frame.viewport = glm::vec4(viewportSize, 0.0f, 0.0f);
+}
+
+void FrameUniforms::ClearLights() {
+    lighting.counts = glm::ivec4(0);
+}
+
+bool FrameUniforms::AddLight(const Light& light) {
+    return light.PackInto(lighting);
+}
+
+void FrameUniforms::Upload() {
+    if (frameBuffer == 0) {
+        return;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameBlock), &frame);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightingBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightingBlock), &lighting);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,96 @@
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Uniform blocks shared by every program. The structs mirror the std140 layout of the blocks declared
+// in shaders/*.glsl; every member is a vec4 or mat4 so the C++ and std140 layouts are the same.
+
+const char* const FRAME_BLOCK_NAME = "Frame";
+const char* const LIGHTING_BLOCK_NAME = "Lighting";
+const GLuint FRAME_BLOCK_BINDING = 0;
+const GLuint LIGHTING_BLOCK_BINDING = 1;
+
+// Array sizes of the Lighting block; must match the shaders
+const int MAX_POINT_LIGHTS = 8;
+const int MAX_SPOT_LIGHTS = 4;
+
+// Camera data, written once per frame
+struct FrameBlock {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::mat4 viewProjection;
+    glm::vec4 cameraPosition;  // w unused
+    glm::vec4 viewport;        // xy = size in pixels
+};
+
+struct DirectionalLightBlock {
+    glm::vec4 direction;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+
+struct PointLightBlock {
+    glm::vec4 position;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 attenuation;  // x = constant, y = linear, z = quadratic
+};
+
+struct SpotLightBlock {
+    glm::vec4 position;
+    glm::vec4 direction;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 attenuation;  // x = constant, y = linear, z = quadratic
+    glm::vec4 cone;         // x = cosine of the inner cut-off, y = cosine of the outer cut-off
+};
+
+// Lights of the scene, packed by Light::PackInto
+struct LightingBlock {
+    DirectionalLightBlock directional;
+    PointLightBlock pointLights[MAX_POINT_LIGHTS];
+    SpotLightBlock spotLights[MAX_SPOT_LIGHTS];
+    glm::ivec4 counts;  // x = directional (0 or 1), y = point lights, z = spot lights
+};
+
+static_assert(sizeof(FrameBlock) == 224, "FrameBlock must match the std140 Frame block");
+static_assert(sizeof(LightingBlock) == 64 + 80 * MAX_POINT_LIGHTS + 112 * MAX_SPOT_LIGHTS + 16,
+    "LightingBlock must match the std140 Lighting block");
+
+class Light;
+
+// Owns the Frame and Lighting uniform buffers and keeps them bound to their binding points.
+// Shaders bind their blocks to the same points when they are linked.
+class FrameUniforms {
+public:
+    FrameUniforms();
+    ~FrameUniforms();
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    // Creates both buffers; needs a GL context
+    void Create();
+
+    void SetCamera(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& position, const glm::vec2& viewportSize);
+    void ClearLights();
+    // Returns false when the block has no room left for the light's kind
+    bool AddLight(const Light& light);
+
+    // Writes both blocks; call once per frame before drawing
+    void Upload();
+
+    const FrameBlock& GetFrame() const { return frame; }
+    const LightingBlock& GetLighting() const { return lighting; }
+
+private:
+    GLuint frameBuffer, lightingBuffer;
+    FrameBlock frame;
+    LightingBlock lighting;
+};
+
+#endif
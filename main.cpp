@@ -3,16 +3,21 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <cstdlib>
 #include <vector>
+#include <string>
 
 // Include headers
 #include "Camera.h"
-#include "Shader.h"
-#include "Terrain.h"
-#include "Path.h"
-#include "SkyDome.h"
-#include "Light.h"
-#include "PathTracer.h"
+#include "Scene.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+#include "Benchmarks.h"
+#include "Headless.h"
+#include "InputRecording.h"
+#include "Simulation.h"
+#include "TiledHeightmap.h"
+#include "TextureCompression.h"
 
 // Constants
 const unsigned int SCR_WIDTH = 1280;
@@ -29,14 +34,80 @@ float lastFrame = 0.0f;
 float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
+// Offsets gathered by mouse_callback since the last frame's input was read
+float mouseOffsetX = 0.0f;
+float mouseOffsetY = 0.0f;
 
 // Function declarations
-void processInput(GLFWwindow* window, float deltaTime);
+InputFrame processInput(GLFWwindow* window, float deltaTime);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 
-int main()
+int main(int argc, char** argv)
 {
+    // Headless CPU benchmarks: 3D_HikingSimulator --bench [name]
+    if (argc >= 2 && std::string(argv[1]) == "--bench")
+    {
+        return RunBenchmarks(argc >= 3 ? argv[2] : "all");
+    }
+
+    // Offscreen frame-time benchmark: 3D_HikingSimulator --headless [frames] [report.json]
+    if (argc >= 2 && std::string(argv[1]) == "--headless")
+    {
+        HeadlessOptions options = { HEADLESS_DEFAULT_FRAMES, HEADLESS_DEFAULT_WIDTH, HEADLESS_DEFAULT_HEIGHT, HEADLESS_DEFAULT_REPORT, "" };
+        if (argc >= 3)
+            options.frames = std::atoi(argv[2]);
+        if (argc >= 4)
+            options.reportPath = argv[3];
+        return RunHeadless(options);
+    }
+
+    // Replay of recorded input, rendered offscreen: 3D_HikingSimulator --replay input.bin [report.json]
+    if (argc >= 2 && std::string(argv[1]) == "--replay")
+    {
+        if (argc < 3)
+        {
+            std::cerr << "Usage: 3D_HikingSimulator --replay input.bin [report.json]\n";
+            return -1;
+        }
+        HeadlessOptions options = { HEADLESS_DEFAULT_FRAMES, HEADLESS_DEFAULT_WIDTH, HEADLESS_DEFAULT_HEIGHT, HEADLESS_DEFAULT_REPORT, argv[2] };
+        if (argc >= 4)
+            options.reportPath = argv[3];
+        return RunHeadless(options);
+    }
+
+    // Interactive session whose input is written to a file: 3D_HikingSimulator --record [input.bin]
+    std::string recordPath;
+    if (argc >= 2 && std::string(argv[1]) == "--record")
+    {
+        recordPath = argc >= 3 ? argv[2] : INPUT_RECORDING_DEFAULT;
+    }
+
+    // Offline heightmap tiling: 3D_HikingSimulator --convert-heightmap in.png out.hmt [tileSize]
+    if (argc >= 2 && std::string(argv[1]) == "--convert-heightmap")
+    {
+        if (argc < 4)
+        {
+            std::cerr << "Usage: 3D_HikingSimulator --convert-heightmap in.png out.hmt [tileSize]\n";
+            return -1;
+        }
+        int tileSize = argc >= 5 ? std::atoi(argv[4]) : TILED_HEIGHTMAP_DEFAULT_TILE_SIZE;
+        return ConvertHeightmapToTiles(argv[2], argv[3], tileSize) ? 0 : -1;
+    }
+
+    // Offline texture compression: 3D_HikingSimulator --compress-texture in.png [out.ktx] [--flip]
+    if (argc >= 2 && std::string(argv[1]) == "--compress-texture")
+    {
+        if (argc < 3 || std::string(argv[2]) == "--flip")
+        {
+            std::cerr << "Usage: 3D_HikingSimulator --compress-texture in.png [out.ktx] [--flip]\n";
+            return -1;
+        }
+        bool flip = std::string(argv[argc - 1]) == "--flip";
+        std::string outputPath = argc - (flip ? 1 : 0) >= 4 ? argv[3] : CompressedTexturePath(argv[2]);
+        return CompressTexture(argv[2], outputPath, flip) ? 0 : -1;
+    }
+
     // GLFW initialization and configuration
     if (!glfwInit())
     {
@@ -74,46 +145,39 @@ int main()
         std::cerr << "Failed to initialize GLAD\n";
         return -1;
     }
+    // Linked programs are reused from shader_cache/ when the driver supports program binaries
+    InitProgramCache((GLADloadproc)glfwGetProcAddress);
 
-    // Configure global OpenGL state
-    glEnable(GL_DEPTH_TEST);
-
-    // Build and compile shaders
-    Shader terrainShader("shaders/terrain_vertex.glsl", "shaders/terrain_fragment.glsl");
-    Shader pathShader("shaders/path_vertex.glsl", "shaders/path_fragment.glsl");
-    Shader tracerShader("shaders/tracer_vertex.glsl", "shaders/tracer_fragment.glsl");
-    Shader skyDomeShader("shaders/skydome_vertex.glsl", "shaders/skydome_fragment.glsl");
-
-    // Load terrain
-    Terrain terrain("assets/heightmaps/terrain_heightmap.png", "assets/textures/terrain_texture.png");
-    terrain.LoadGrassTexture("assets/textures/grass_texture.png");
-
-    // Load path
-    Path path("assets/gpx/hiking_path.gpx", terrain);
+    // Load assets, compile shaders and upload everything
+    Scene scene;
+    scene.Load();
+    Terrain& terrain = scene.GetTerrain();
+    Path& path = scene.GetPath();
+    PathTracer& pathTracer = scene.GetPathTracer();
 
     // Set camera position to the starting point of the hiking path
     glm::vec3 pathStartPosition = path.GetStartingPosition();
-    float cameraHeightOffset = 2.0f; 
     camera.Position = glm::vec3(
         pathStartPosition.x,
-        pathStartPosition.y + cameraHeightOffset,
+        pathStartPosition.y + SCENE_CAMERA_HEIGHT,
         pathStartPosition.z
     );
 
-    // Initialize SkyDome
-    SkyDome skyDome("assets/skydome/sky_dome_texture.png");
+    // Camera movement, terrain following and the trail run in fixed steps; the trail starts here
+    Simulation simulation(scene);
+    simulation.Reset(camera);
 
-    // Lighting
-    DirectionalLight dirLight;
-    dirLight.direction = glm::vec3(-0.7f, -1.0f, -0.7f);
-    dirLight.ambient = glm::vec3(0.4f);
-    dirLight.diffuse = glm::vec3(0.8f);
-    dirLight.specular = glm::vec3(1.0f);
+    // A replay starts from the same pose as the recording
+    InputRecorder inputRecorder;
+    if (!recordPath.empty())
+    {
+        inputRecorder.Start(recordPath, camera);
+    }
 
-    // Path tracer to keep track of the camera's path
-    PathTracer pathTracer;
-    // Add initial position
-    pathTracer.AddPoint(camera.Position);
+    // Frame statistics shown in the window title
+    float statsTimer = 0.0f;
+    int statsFrames = 0;
+    int statsSteps = 0;
 
     // Render loop
     while (!glfwWindowShouldClose(window))
@@ -124,119 +188,112 @@ int main()
         lastFrame = currentFrame;
 
         // Input
-        processInput(window, deltaTime);
-
-        // Keep the camera within the terrain bounds
-        float maxX = static_cast<float>(terrain.GetWidth() - 1);
-        float maxZ = static_cast<float>(terrain.GetHeight() - 1);
-
-        if (camera.Position.x < 0.0f)
-            camera.Position.x = 0.0f;
-        if (camera.Position.x > maxX)
-            camera.Position.x = maxX;
-        if (camera.Position.z < 0.0f)
-            camera.Position.z = 0.0f;
-        if (camera.Position.z > maxZ)
-            camera.Position.z = maxZ;
-
-        // Update camera's Y-position based on terrain height
-        float terrainHeight = terrain.GetHeightAt(camera.Position.x, camera.Position.z);
-        float cameraHeightOffset = 2.0f; // Adjust as needed
-        camera.Position.y = terrainHeight + cameraHeightOffset;
-
-        // Record the camera position for the path tracer if the camera has moved significantly
-        static glm::vec3 lastRecordedPosition = camera.Position;
-        float distanceMoved = glm::length(camera.Position - lastRecordedPosition);
-        if (distanceMoved > 0.5f) // Adjust threshold as needed
+        InputFrame input = processInput(window, deltaTime);
+
+        // Toggle terrain and path level of detail on key press
+        static bool lodKeyWasDown = false;
+        bool lodKeyDown = glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS;
+        if (lodKeyDown && !lodKeyWasDown)
+            input.keys |= INPUT_KEY_TOGGLE_LOD;
+        lodKeyWasDown = lodKeyDown;
+
+        // Everything that changes the rendered frame goes through the recorder, so a replay draws the same frames.
+        // The simulation leaves the camera between its last two steps.
+        inputRecorder.Record(input);
+        statsSteps += simulation.Advance(input, camera);
+
+        // Toggle the per-pass profiler; its trace is written when it is switched off
+        static bool profileKeyWasDown = false;
+        bool profileKeyDown = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (profileKeyDown && !profileKeyWasDown)
         {
-            pathTracer.AddPoint(camera.Position);
-            lastRecordedPosition = camera.Position;
+            Profiler& profiler = scene.GetProfiler();
+            profiler.SetEnabled(!profiler.IsEnabled());
+            if (!profiler.IsEnabled())
+            {
+                profiler.WriteChromeTrace(PROFILER_DEFAULT_TRACE);
+            }
         }
+        profileKeyWasDown = profileKeyDown;
+
+        // Rebuild shaders when their files are saved; R reloads them all where file events are unavailable
+        static bool reloadKeyWasDown = false;
+        bool reloadKeyDown = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+        scene.UpdateShaders(reloadKeyDown && !reloadKeyWasDown);
+        reloadKeyWasDown = reloadKeyDown;
 
-        // Clear buffers
-        glClearColor(0.1f, 0.7f, 0.9f, 1.0f); // aqua color
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Count the uniform and state calls of this frame for the window title
+        Shader::ResetUniformCallCount();
+        ResetGLStateStats();
 
-        // View and projection matrices
-        glm::mat4 view = camera.GetViewMatrix();
         int width, height;
         glfwGetFramebufferSize(window, &width, &height);
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom),
-            static_cast<float>(width) / static_cast<float>(height), 0.1f, 1000.0f);
-
-        // Render terrain
-        terrainShader.Use();
-        terrainShader.setMat4("projection", projection);
-        terrainShader.setMat4("view", view);
-        glm::mat4 model = glm::mat4(1.0f);
-        terrainShader.setMat4("model", model);
-
-        // Set directional light uniforms
-        terrainShader.setVec3("dirLight.direction", dirLight.direction);
-        terrainShader.setVec3("dirLight.ambient", dirLight.ambient);
-        terrainShader.setVec3("dirLight.diffuse", dirLight.diffuse);
-        terrainShader.setVec3("dirLight.specular", dirLight.specular);
-
-        // Set view position
-        terrainShader.setVec3("viewPos", camera.Position);
-
-        // Set material properties
-        terrainShader.setInt("material.diffuse", 0);
-        terrainShader.setInt("material.grass", 1);
-        terrainShader.setFloat("material.shininess", 32.0f);
-
-        // Render terrain
-        terrain.Render(terrainShader);
-
-        // Render path from GPX
-        pathShader.Use();
-        pathShader.setMat4("projection", projection);
-        pathShader.setMat4("view", view);
-        pathShader.setMat4("model", model);
-        pathShader.setVec3("color", glm::vec3(0.0f, 1.0f, 1.0f));
-        path.Render(pathShader);
-
-        // Render path tracer
-        tracerShader.Use();
-        tracerShader.setMat4("projection", projection);
-        tracerShader.setMat4("view", view);
-        tracerShader.setMat4("model", model);
-        tracerShader.setVec3("color", glm::vec3(1.0f, 0.0f, 1.0f));
-        glLineWidth(5.0f);
-        pathTracer.Render(tracerShader);
-        glLineWidth(1.0f);
-
-        // Render sky dome
-        glDepthMask(GL_FALSE); // Disable depth writing
-        glm::mat4 skyView = glm::mat4(glm::mat3(view)); // Remove translation
-        skyDomeShader.Use();
-        skyDome.Render(skyDomeShader, skyView, projection);
-        glDepthMask(GL_TRUE);
+        scene.Render(camera, width, height);
+
+        // Update the window title with frame and simulation rates, chunk culling, trail, uniform and state call counts once per second,
+        // and print the profiler summary at the same rate while it runs
+        statsTimer += deltaTime;
+        ++statsFrames;
+        if (statsTimer >= 1.0f)
+        {
+            const TerrainCullStats& cullStats = terrain.GetCullStats();
+            std::string title = "3D Hiking Simulator - " + std::to_string(static_cast<int>(statsFrames / statsTimer)) + " FPS"
+                + " - simulation: " + std::to_string(static_cast<int>(statsSteps / statsTimer)) + " steps/s"
+                + " - chunks drawn: " + std::to_string(cullStats.drawnChunks)
+                + ", culled: " + std::to_string(cullStats.culledChunks)
+                + " - triangles: " + std::to_string(cullStats.drawnTriangles)
+                + (terrain.IsLODEnabled() ? " (LOD)" : " (full)")
+                + " - path: " + std::to_string(path.GetLODStats().drawnVertices) + "/" + std::to_string(path.GetPoints().size()) + " points"
+                + " - trail: " + std::to_string(pathTracer.GetPointCount()) + "/" + std::to_string(pathTracer.GetRawPointCount()) + " points"
+                + " - uniforms: " + std::to_string(Shader::GetUniformCallCount()) + "/frame"
+                + " - GL state: " + std::to_string(GetGLStateStats().issued) + " issued, "
+                + std::to_string(GetGLStateStats().elided) + " elided";
+            glfwSetWindowTitle(window, title.c_str());
+            if (scene.GetProfiler().IsEnabled())
+            {
+                scene.GetProfiler().PrintSummary(std::cout);
+            }
+            statsTimer = 0.0f;
+            statsFrames = 0;
+            statsSteps = 0;
+        }
 
         // Swap buffers and poll IO events
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
+    if (scene.GetProfiler().IsEnabled())
+    {
+        scene.GetProfiler().SetEnabled(false);
+        scene.GetProfiler().WriteChromeTrace(PROFILER_DEFAULT_TRACE);
+    }
+    inputRecorder.Stop();
+
     // Terminate GLFW
     glfwTerminate();
     return 0;
 }
 
-// Process input
-void processInput(GLFWwindow* window, float deltaTime)
+// Process input: gathers the held movement keys and the mouse offsets since the last frame
+InputFrame processInput(GLFWwindow* window, float deltaTime)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
+    InputFrame input = { deltaTime, mouseOffsetX, mouseOffsetY, 0 };
+    mouseOffsetX = 0.0f;
+    mouseOffsetY = 0.0f;
+
     // Movement
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        camera.ProcessKeyboard(FORWARD, deltaTime);
+        input.keys |= INPUT_KEY_FORWARD;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        camera.ProcessKeyboard(BACKWARD, deltaTime);
+        input.keys |= INPUT_KEY_BACKWARD;
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        camera.ProcessKeyboard(LEFT, deltaTime);
+        input.keys |= INPUT_KEY_LEFT;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        camera.ProcessKeyboard(RIGHT, deltaTime);
+        input.keys |= INPUT_KEY_RIGHT;
+    return input;
 }
 
 // Mouse callback
@@ -255,7 +312,9 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
     lastX = static_cast<float>(xpos);
     lastY = static_cast<float>(ypos);
 
-    camera.ProcessMouseMovement(xoffset, yoffset);
+    // Applied to the camera with the rest of the next frame's input
+    mouseOffsetX += xoffset;
+    mouseOffsetY += yoffset;
 }
 
 // Framebuffer size callback
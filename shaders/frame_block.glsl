@@ -0,0 +1,9 @@
+// shaders/frame_block.glsl
+// Per-frame camera data; std140 layout of FrameBlock in UniformBlocks.h
+layout(std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    mat4 viewProjection;
+    vec4 cameraPosition;  // w unused
+    vec4 viewport;        // xy = size in pixels
+};
@@ -0,0 +1,84 @@
+// shaders/lighting.glsl
+// Lights of the scene; std140 layout of LightingBlock in UniformBlocks.h
+struct DirectionalLight {
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+struct PointLight {
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;  // x = constant, y = linear, z = quadratic
+};
+
+struct SpotLight {
+    vec4 position;
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;  // x = constant, y = linear, z = quadratic
+    vec4 cone;         // x = cosine of the inner cut-off, y = cosine of the outer cut-off
+};
+
+#define MAX_POINT_LIGHTS 8
+#define MAX_SPOT_LIGHTS 4
+
+layout(std140) uniform Lighting {
+    DirectionalLight dirLight;
+    PointLight pointLights[MAX_POINT_LIGHTS];
+    SpotLight spotLights[MAX_SPOT_LIGHTS];
+    ivec4 lightCounts;  // x = directional (0 or 1), y = point lights, z = spot lights
+};
+
+// Ambient, diffuse and specular terms of one light arriving from lightDir
+vec3 shade(vec3 lightDir, vec3 ambientColor, vec3 diffuseColor, vec3 specularColor, vec3 norm, vec3 viewDir,
+    vec3 albedo, float shininess)
+{
+    vec3 ambient = ambientColor * albedo;
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diffuseColor * diff * albedo;
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 specular = specularColor * spec;
+    return ambient + diffuse + specular;
+}
+
+float attenuate(vec4 attenuation, float distance)
+{
+    return 1.0 / (attenuation.x + attenuation.y * distance + attenuation.z * distance * distance);
+}
+
+// Sum of every light in the Lighting block at a world-space position
+vec3 computeLighting(vec3 fragPos, vec3 norm, vec3 viewDir, vec3 albedo, float shininess)
+{
+    vec3 lighting = vec3(0.0);
+    if (lightCounts.x > 0)
+    {
+        lighting += shade(normalize(-dirLight.direction.xyz), dirLight.ambient.rgb, dirLight.diffuse.rgb,
+            dirLight.specular.rgb, norm, viewDir, albedo, shininess);
+    }
+    for (int i = 0; i < lightCounts.y; ++i)
+    {
+        vec3 toLight = pointLights[i].position.xyz - fragPos;
+        float attenuation = attenuate(pointLights[i].attenuation, length(toLight));
+        lighting += attenuation * shade(normalize(toLight), pointLights[i].ambient.rgb, pointLights[i].diffuse.rgb,
+            pointLights[i].specular.rgb, norm, viewDir, albedo, shininess);
+    }
+    for (int i = 0; i < lightCounts.z; ++i)
+    {
+        vec3 toLight = spotLights[i].position.xyz - fragPos;
+        vec3 lightDir = normalize(toLight);
+        float theta = dot(lightDir, normalize(-spotLights[i].direction.xyz));
+        float epsilon = spotLights[i].cone.x - spotLights[i].cone.y;
+        float intensity = clamp((theta - spotLights[i].cone.y) / epsilon, 0.0, 1.0);
+        float attenuation = attenuate(spotLights[i].attenuation, length(toLight));
+        lighting += attenuation * shade(lightDir, spotLights[i].ambient.rgb, intensity * spotLights[i].diffuse.rgb,
+            intensity * spotLights[i].specular.rgb, norm, viewDir, albedo, shininess);
+    }
+    return lighting;
+}
@@ -0,0 +1,11 @@
+// shaders/line_fragment.glsl
+#version 330 core
+
+in vec4 lineColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = lineColor;
+}
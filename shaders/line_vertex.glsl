@@ -0,0 +1,76 @@
+// shaders/line_vertex.glsl
+#version 330 core
+
+// One instance per segment; gl_VertexID 0..3 are the corners of a triangle strip quad:
+// bit 1 selects the segment end, bit 0 the side of the line
+uniform samplerBuffer vertices;  // xyz = position, w = width in pixels
+uniform samplerBuffer colors;
+uniform usamplerBuffer indices;
+uniform bool indexed;
+uniform int firstVertex;
+uniform int ringSize;
+
+#include "frame_block.glsl"
+
+out vec4 lineColor;
+
+const uint LINE_BREAK = 0xFFFFFFFFu;
+const float NEAR_W = 1e-4;
+
+void main()
+{
+    int end = gl_VertexID >> 1;
+    float side = (gl_VertexID & 1) == 0 ? -1.0 : 1.0;
+
+    int indexA, indexB;
+    if (indexed) {
+        uint a = texelFetch(indices, gl_InstanceID).r;
+        uint b = texelFetch(indices, gl_InstanceID + 1).r;
+        if (a == LINE_BREAK || b == LINE_BREAK) {
+            // Collapse the quad; nothing is rasterised
+            gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+            lineColor = vec4(0.0);
+            return;
+        }
+        indexA = int(a);
+        indexB = int(b);
+    }
+    else {
+        indexA = (firstVertex + gl_InstanceID) % ringSize;
+        indexB = (firstVertex + gl_InstanceID + 1) % ringSize;
+    }
+
+    vec4 vertexA = texelFetch(vertices, indexA);
+    vec4 vertexB = texelFetch(vertices, indexB);
+    vec4 clipA = viewProjection * vec4(vertexA.xyz, 1.0);
+    vec4 clipB = viewProjection * vec4(vertexB.xyz, 1.0);
+
+    // Clip the segment against the near plane so both ends project in front of the camera
+    if (clipA.w < NEAR_W && clipB.w < NEAR_W) {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        lineColor = vec4(0.0);
+        return;
+    }
+    if (clipA.w < NEAR_W) {
+        clipA = mix(clipA, clipB, (NEAR_W - clipA.w) / (clipB.w - clipA.w));
+    }
+    else if (clipB.w < NEAR_W) {
+        clipB = mix(clipB, clipA, (NEAR_W - clipB.w) / (clipA.w - clipB.w));
+    }
+
+    vec2 halfViewport = 0.5 * viewport.xy;
+    vec2 screenA = clipA.xy / clipA.w * halfViewport;
+    vec2 screenB = clipB.xy / clipB.w * halfViewport;
+    vec2 direction = screenB - screenA;
+    direction = dot(direction, direction) > 0.0 ? normalize(direction) : vec2(1.0, 0.0);
+    vec2 normal = vec2(-direction.y, direction.x);
+
+    // Widen across the segment and extend past each end by half the width, which closes the joins
+    vec4 clip = end == 0 ? clipA : clipB;
+    float width = end == 0 ? vertexA.w : vertexB.w;
+    vec2 offset = (normal * side + direction * (end == 0 ? -1.0 : 1.0)) * (0.5 * width);
+    clip.xy += offset / halfViewport * clip.w;
+
+    gl_Position = clip;
+    lineColor = texelFetch(colors, end == 0 ? indexA : indexB);
+}
@@ -5,11 +5,11 @@ layout(location = 1) in vec2 aTexCoords; // Texture coordinates
 
 out vec2 TexCoords;
 
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_block.glsl"
 
 void main()
 {
     TexCoords = vec2(aTexCoords.x, aTexCoords.y);
-    gl_Position = projection * view * vec4(aPos, 1.0);
+    // Remove translation from the view matrix so the dome stays centred on the camera
+    gl_Position = projection * mat4(mat3(view)) * vec4(aPos, 1.0);
 }
@@ -6,13 +6,8 @@ struct Material {
     float shininess;      // Shininess for specular reflection
 };
 
-struct DirectionalLight {
-    vec3 direction;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
+#include "lighting.glsl"
+#include "frame_block.glsl"
 
 in vec3 FragPos;        // Fragment position in world space
 in vec3 Normal;         // Fragment normal in world space
@@ -21,26 +16,15 @@ in float Height;        // Height value from vertex shader
 
 out vec4 FragColor;     // Final fragment color
 
-uniform vec3 viewPos;           // Position of the camera/viewer
 uniform Material material;      // Material properties
-uniform DirectionalLight dirLight; // Directional light properties
 
 void main()
 {
-    // Ambient component
-    vec3 ambient = dirLight.ambient * texture(material.diffuse, TexCoords).rgb;
-
-    // Diffuse component
+    vec3 albedo = texture(material.diffuse, TexCoords).rgb;
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(-dirLight.direction);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = dirLight.diffuse * diff * texture(material.diffuse, TexCoords).rgb;
+    vec3 viewDir = normalize(cameraPosition.xyz - FragPos);
 
-    // Specular component
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = dirLight.specular * spec;
+    vec3 lighting = computeLighting(FragPos, norm, viewDir, albedo, material.shininess);
 
     // Adjusted height-based grass blending
     float minHeight = 0.0;   // Minimum height for grass
@@ -48,7 +32,7 @@ void main()
     float heightFactor = clamp((Height - minHeight) / (maxHeight - minHeight), 0.0, 1.0);
     heightFactor = 1.0 - heightFactor; // Invert to have grass at lower heights
 
-    vec3 baseColor = ambient + diffuse + specular; // Base lighting result
+    vec3 baseColor = lighting; // Base lighting result
     vec3 grassColor = texture(material.grass, TexCoords).rgb; // Grass texture color
 
     // Blend the base color with the grass texture based on height
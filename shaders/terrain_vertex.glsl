@@ -3,24 +3,68 @@
 layout(location = 0) in vec3 aPos;       // Vertex position
 layout(location = 1) in vec3 aNormal;    // Vertex normal
 layout(location = 2) in vec2 aTexCoords; // Texture coordinates
+layout(location = 3) in float aHeight;   // Compact format: normalized 16-bit height
+layout(location = 4) in vec2 aOctNormal; // Compact format: octahedral-encoded normal
 
 out vec3 FragPos;        // Position of the fragment in world space
 out vec3 Normal;         // Normal of the fragment in world space
 out vec2 TexCoords;      // Texture coordinates
 out float Height;        // Terrain height (y-coordinate) for height-based texturing
 
+#include "frame_block.glsl"
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Compact vertex layout (see TerrainCompact.h)
+uniform bool compactVertices;
+uniform int gridWidth;
+uniform int gridHeight;
+uniform float heightOffset;
+uniform float heightRange;
+uniform float uvScale;
+uniform int chunkSize;   // Non-zero when vertices are stored chunk by chunk
+uniform int chunksX;
+
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0)
+    {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+        n.xz = (1.0 - abs(n.zx)) * signs;
+    }
+    return normalize(n);
+}
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0)); // Calculate world position of the vertex
-    Normal = mat3(transpose(inverse(model))) * aNormal; // Transform normal to world space
-    TexCoords = aTexCoords;
+    vec3 position = aPos;
+    vec3 normal = aNormal;
+    vec2 texCoords = aTexCoords;
+    if (compactVertices)
+    {
+        // Rebuild grid position and UV from the vertex index (base vertex included)
+        int x = gl_VertexID % gridWidth;
+        int z = gl_VertexID / gridWidth;
+        if (chunkSize > 0)
+        {
+            int stride = chunkSize + 1;
+            int chunk = gl_VertexID / (stride * stride);
+            int local = gl_VertexID % (stride * stride);
+            x = (chunk % chunksX) * chunkSize + local % stride;
+            z = (chunk / chunksX) * chunkSize + local / stride;
+        }
+        position = vec3(float(x), heightOffset + aHeight * heightRange, float(z));
+        normal = decodeOctahedral(aOctNormal);
+        texCoords = vec2(float(x) / (float(gridWidth) - 1.0), float(z) / (float(gridHeight) - 1.0)) * uvScale;
+    }
+
+    FragPos = vec3(model * vec4(position, 1.0)); // Calculate world position of the vertex
+    Normal = mat3(transpose(inverse(model))) * normal; // Transform normal to world space
+    TexCoords = texCoords;
     // Match with height scaling in terrain generation
     float terrainScale = 20.0;
     Height = FragPos.y / terrainScale;
 
-    gl_Position = projection * view * vec4(FragPos, 1.0); // Transform vertex to clip space
+    gl_Position = viewProjection * vec4(FragPos, 1.0); // Transform vertex to clip space
 }